@@ -1,4 +1,5 @@
 #include "cloth.h"
+#include "strain_color.h"
 #include <algorithm>
 #include <cmath>
 
@@ -27,46 +28,20 @@ Cloth::Cloth(int row_, int col_, float rest_distance_, float width_, float heigh
     reset();
 }
 
-// 初始化所有粒子
-void Cloth::init_particles()
-{
-    particles.clear();
-    float x_offset = get_x_offset();
-    float y_offset = get_y_offset();
-    float z_offset = get_z_offset();
-    for (int r = 0; r < row; ++r) {
-        for (int c = 0; c < col; ++c) {
-            float x = c * rest_distance + x_offset;
-            float y = r * rest_distance + y_offset;
-            float z = (float)(c + r) / (row + col) * depth * 0.2f + z_offset; // 简单初始z扰动
-            bool pinned = (r == 0); // 顶部粒子固定
-            particles.emplace_back(x, y, z, pinned);
-        }
-    }
-}
-
-// 初始化所有约束
-void Cloth::init_constraints()
-{
-    constraints.clear();
-    for (int r = 0; r < row; ++r) {
-        for (int c = 0; c < col; ++c) {
-            int idx = r * col + c;
-            if (c < col - 1) {
-                constraints.emplace_back(&particles[idx], &particles[idx + 1]);
-            }
-            if (r < row - 1) {
-                constraints.emplace_back(&particles[idx], &particles[idx + col]);
-            }
-        }
-    }
-}
-
+// 重建网格：顶部粒子固定，沿对角线加一点 z 扰动
 void Cloth::reset()
 {
-    init_particles();
-    init_constraints();
+    GridPlacement placement;
+    placement.origin = Vector3f(get_x_offset(), get_y_offset(), get_z_offset());
+    placement.depth_ramp = depth * 0.2f;
+    placement.pin_top_row = true;
+    build_grid(GridType::Square, row, col, rest_distance, placement, particles, constraints, dihedrals);
     dragged_particle = nullptr;
+    strain.clear();
+    solver.set_grid(row, col);
+    solver.invalidate_tethers();
+    implicit_integrator.invalidate();
+    projective_dynamics.invalidate();
 }
 
 // 更新物理状态
@@ -76,14 +51,20 @@ void Cloth::update(float gravity_, float wind, float time_step, int satisfy_iter
     // 施加重力和风力
     for (auto& p : particles) {
         p.apply_force(Vector3f(wind, gravity, 0));
-        p.update(time_step);
+        if (integrator == Integrator::Verlet)
+            p.update(time_step);
         p.constrain_to_bounds(width, height, depth);
     }
-    // 约束迭代
-    for (int i = 0; i < satisfy_iter; ++i) {
-        for (auto& c : constraints) {
-            c.satisfy();
-        }
+    if (integrator == Integrator::ImplicitEuler)
+        implicit_integrator.step(particles, constraints, time_step);
+    // 约束迭代（误差收敛后提前结束）
+    solver.settings.max_iterations = satisfy_iter;
+    if (integrator == Integrator::ProjectiveDynamics) {
+        strain.clear();
+        projective_dynamics.step(particles, constraints, time_step, solver.settings);
+    } else {
+        strain.resize(constraints.size());
+        solver.solve(particles, constraints, dihedrals, strain);
     }
 }
 
@@ -97,13 +78,18 @@ static sf::Color get_particle_color(const Particle& p, float height)
     return sf::Color(255, std::clamp(green, 0, 255), std::clamp(blue, 0, 255));
 }
 
-// 计算约束线颜色
-static sf::Color get_constraint_color(const Constraint& c)
-{
-    float len = (c.p1->position - c.p2->position).length();
-    float t = std::min(std::abs(len - c.initial_length) / (c.initial_length * 0.5f), 1.0f);
-    uint8_t color_val = static_cast<uint8_t>(255 * (1 - t));
-    return sf::Color(255, color_val, color_val);
+// 计算约束线颜色：优先用求解器最后一轮测得的应变，没有时按当前长度现算
+static sf::Color get_constraint_color(const Constraint& c, std::span<const float> strain, size_t index)
+{
+    float e;
+    if (index < strain.size()) {
+        e = strain[index];
+    } else {
+        float len = (c.p1->position - c.p2->position).length();
+        e = std::abs(len - c.initial_length) / c.initial_length;
+    }
+    const Rgb rgb = strain_color(e);
+    return sf::Color(rgb.r, rgb.g, rgb.b);
 }
 
 // 三维投影到二维（简单正交投影）
@@ -122,10 +108,11 @@ void Cloth::draw(sf::RenderWindow& window)
         window.draw(&point, 1, sf::PrimitiveType::Points);
     }
     // 画约束
-    for (const auto& c : constraints) {
-        if (!c.active)
+    for (size_t i = 0; i < constraints.size(); ++i) {
+        const Constraint& c = constraints[i];
+        if (!c.active || c.type == ConstraintType::Bending)
             continue;
-        sf::Color lineColor = get_constraint_color(c);
+        sf::Color lineColor = get_constraint_color(c, strain, i);
         sf::Vertex line[] = {
             { project(c.p1->position), lineColor },
             { project(c.p2->position), lineColor },
@@ -166,6 +153,8 @@ void Cloth::stop_drag()
 void Cloth::toggle_pin(const Vector3f& pos)
 {
     Particle* p = get_nearest_particle(pos);
-    if (p)
+    if (p) {
         p->is_pinned = !p->is_pinned;
+        solver.invalidate_tethers();
+    }
 }
\ No newline at end of file
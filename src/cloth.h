@@ -1,6 +1,10 @@
 #pragma once
 #include "constraint.h"
+#include "grid_topology.h"
+#include "implicit_integrator.h"
 #include "particle.h"
+#include "projective_dynamics.h"
+#include "solver.h"
 #include "vector3f.h"
 #include <SFML/Graphics.hpp>
 #include <vector>
@@ -10,7 +14,7 @@ class Cloth {
 public:
     Cloth(int row, int col, float rest_distance, float width, float height, float depth = 1000.0f);
     void reset(); // 重置布料
-    void update(float gravity, float wind, float time_step, int satisfy_iter); // 更新物理状态
+    void update(float gravity, float wind, float time_step, int satisfy_iter); // 更新物理状态，satisfy_iter 为迭代上限
     void draw(sf::RenderWindow& window); // 绘制布料
 
     // 交互操作
@@ -28,6 +32,14 @@ public:
     // 只读访问（如需外部遍历）
     const std::vector<Particle>& get_particles() const { return particles; }
     const std::vector<Constraint>& get_constraints() const { return constraints; }
+    const SolverStats& get_solver_stats() const { return solver.get_last_stats(); }
+    void set_solver_tolerance(float tol) { solver.settings.tolerance = tol; }
+    void set_solver_relaxation(float omega) { solver.settings.relaxation = omega; }
+    void set_solver_acceleration(SolverAcceleration acc) { solver.settings.acceleration = acc; }
+    void set_multigrid(bool enabled) { solver.settings.multigrid = enabled; }
+    void set_tethers(bool enabled) { solver.settings.tethers = enabled; }
+    void set_batch_period(ConstraintType type, int period) { solver.settings.batch_period[static_cast<int>(type)] = period; }
+    void set_integrator(Integrator i) { integrator = i; }
 
 private:
     int row, col; // 行列数
@@ -38,10 +50,13 @@ private:
 
     std::vector<Particle> particles;
     std::vector<Constraint> constraints;
+    std::vector<DihedralConstraint> dihedrals; // 二面角弯曲约束
     Particle* dragged_particle = nullptr;
-
-    void init_particles(); // 初始化粒子
-    void init_constraints(); // 初始化约束
+    ConstraintSolver solver;
+    std::vector<float> strain; // 求解器上一步写出的约束应变；投影动力学不经过该求解器，此时为空
+    Integrator integrator = Integrator::Verlet;
+    ImplicitIntegrator implicit_integrator;
+    ProjectiveDynamics projective_dynamics;
 
     // 辅助：计算粒子初始位置偏移
     float get_x_offset() const;
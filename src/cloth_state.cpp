@@ -1,4 +1,5 @@
 #include "cloth_state.h"
+#include "mesh_order.h"
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -18,7 +19,7 @@ bool ClothState::save(const std::vector<Particle>& particles, const std::vector<
     for (const auto& c : constraints) {
         int idx1 = static_cast<int>(c.p1 - &particles[0]);
         int idx2 = static_cast<int>(c.p2 - &particles[0]);
-        ofs << idx1 << " " << idx2 << "\n";
+        ofs << idx1 << " " << idx2 << " " << static_cast<int>(c.type) << " " << c.stiffness << "\n";
     }
     return true;
 }
@@ -54,8 +55,18 @@ bool ClothState::load(std::vector<Particle>& particles, std::vector<Constraint>&
         std::istringstream iss(line);
         if (!(iss >> idx1 >> idx2))
             continue;
-        if (idx1 >= 0 && idx1 < particles.size() && idx2 >= 0 && idx2 < particles.size())
+        if (idx1 >= 0 && idx1 < particles.size() && idx2 >= 0 && idx2 < particles.size()) {
             constraints.emplace_back(&particles[idx1], &particles[idx2]);
+            // 类别和刚度为可选列，旧文件只有两个下标
+            int type;
+            float stiffness;
+            if (iss >> type >> stiffness && type >= 0 && type <= static_cast<int>(ConstraintType::Bending)) {
+                constraints.back().type = static_cast<ConstraintType>(type);
+                constraints.back().stiffness = stiffness;
+            }
+        }
     }
+    // 文件里的顺序任意，按空间位置重排粒子和约束
+    reorder_mesh(particles, constraints);
     return true;
 }
\ No newline at end of file
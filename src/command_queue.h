@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// 有界无锁命令队列（每个槽位带序号的环形缓冲区）：任意线程 push，模拟在步边界 drain。
+// 生产者和消费者都只用原子操作，物理线程执行命令时不需要加锁
+template <typename T, size_t Capacity = 1024>
+class CommandQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    CommandQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    // 队列已满时返回 false
+    bool push(const T& value)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (Capacity - 1)];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 队列为空时返回 false
+    bool pop(T& out)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (Capacity - 1)];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = slot.value;
+                    slot.sequence.store(pos + Capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 按入队顺序取出当前所有命令交给 fn
+    template <typename Fn>
+    size_t drain(Fn&& fn)
+    {
+        size_t count = 0;
+        T value;
+        while (pop(value)) {
+            fn(value);
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    // 头尾分占缓存行，避免生产者和消费者互相干扰
+    alignas(64) std::atomic<size_t> head { 0 };
+    alignas(64) std::atomic<size_t> tail { 0 };
+    std::array<Slot, Capacity> slots;
+};
@@ -11,4 +11,47 @@ const int DEFAULT_ROW = 60;
 const int DEFAULT_COL = 60;
 const float DEFAULT_REST_DISTANCE = 3.0f;
 
+const float SHEAR_STIFFNESS = 0.5f; // 剪切约束刚度
+const float BENDING_STIFFNESS = 0.2f; // 隔点弯曲约束刚度
+const float DIHEDRAL_STIFFNESS = 0.1f; // 二面角弯曲约束刚度
+
+// 各类约束的求解周期：每 N 次迭代扫描一次，0 表示每帧只扫描一次（二面角随弯曲批次）
+const int STRUCTURAL_PERIOD = 1;
+const int SHEAR_PERIOD = 2;
+const int BENDING_PERIOD = 0;
+
+const int MAX_SOLVER_ITER = 5; // 约束迭代次数上限
+const float SOLVER_TOLERANCE = 0.01f; // 最大相对误差低于此值时提前结束迭代
+const float SOLVER_RELAXATION = 1.0f; // 约束投影松弛因子（SOR）
+const float CHEBYSHEV_SAFETY = 0.9f; // 谱半径估计的保守系数
+const int MULTIGRID_COARSE_ITER = 4; // 多重网格每个粗层的迭代次数
+const int GRID_CACHE_SIZE = 8; // 网格生成器缓存的网格种类数
+
+const float IMPLICIT_STIFFNESS = 2000.0f; // 隐式积分的弹簧刚度
+const float IMPLICIT_DAMPING = 0.05f; // 隐式积分的速度阻尼
+const int IMPLICIT_CG_ITER = 50; // 共轭梯度迭代上限
+const float IMPLICIT_CG_TOLERANCE = 1e-3f; // 共轭梯度相对残差阈值
+
+const float PD_STIFFNESS = 2000.0f; // 投影动力学的约束权重
+const float PD_PIN_WEIGHT = 1e5f; // 投影动力学中固定粒子的附着权重
+
+const float HUD_REFRESH_HZ = 4.0f; // HUD 数值字段每秒刷新次数
+const float CAMERA_NEAR = 0.1f; // 相机近平面距离
+const float LOD_MIN_EDGE_PIXELS = 2.0f; // 渲染 LOD：显示的相邻格点在屏幕上至少相距的像素数
+const float SURFACE_AMBIENT = 0.3f; // 表面渲染的环境光比例
+const float AUTO_TEAR_STRAIN = 0.6f; // 自动撕裂：约束拉伸超过静止长度的这一比例时断开
+const float STRAIN_COLOR_FULL = 0.5f; // 应变热度图：相对应变达到该值时显示为纯红
+const float RENDER_BREAK_STRETCH = 2.0f; // 渲染 LOD 粗线、表面三角形的边长超过静止长度的这一倍数时视为撕开，不画
+
+const int STADIUM_FLAGS = 200; // 体育场场景的旗帜数
+
+const float ENSEMBLE_SETTLE_SPEED = 0.5f; // 集合扫描中判定静止的最大粒子速度
+
+const int REGRESSION_FRAMES = 300; // 回归对照的帧数
+const float REGRESSION_POSITION_TOL = 1e-3f; // 回归对照：位置偏差均方根上限
+const float REGRESSION_ERROR_TOL = 1e-3f; // 回归对照：结构误差超出参考的上限
+const float REGRESSION_ENERGY_TOL = 1e-3f; // 回归对照：能量相对偏差上限
+const float REGRESSION_FINAL_ERROR_TOL = 1e-2f; // 发行设置：末帧结构误差超出参考的上限
+const float REGRESSION_ENERGY_BOUND = 2.0f; // 发行设置：能量绝对值不超过参考最大值的倍数
+
 #endif // CONSTANTS_H
\ No newline at end of file
@@ -3,14 +3,40 @@
 
 #include "particle.h"
 #include <cmath>
+#include <cstdint>
 #include <limits>
 
+// 约束类别：同一类别的约束在数组中连续存放，可单独求解并使用各自的刚度
+enum class ConstraintType {
+    Structural, // 结构（拉伸）
+    Shear, // 剪切（对角）
+    Bending // 隔点弯曲
+};
+constexpr int CONSTRAINT_TYPE_COUNT = 3;
+
+inline const char* constraint_type_name(ConstraintType type)
+{
+    switch (type) {
+    case ConstraintType::Structural:
+        return "Stretch";
+    case ConstraintType::Shear:
+        return "Shear";
+    default:
+        return "Bending";
+    }
+}
+
 class Constraint {
 public:
     Particle* p1;
     Particle* p2;
     float initial_length;
     bool active;
+    ConstraintType type = ConstraintType::Structural;
+    // 着色：同类别同颜色的约束两两不共用粒子，可以并行投影；NO_COLOR 表示未着色（导入的网格），只能串行
+    static constexpr uint8_t NO_COLOR = 0xFF;
+    uint8_t color = NO_COLOR;
+    float stiffness = 1.0f; // 每次投影修正的比例 (0, 1]
 
     Constraint(Particle* p1, Particle* p2)
         : p1(p1)
@@ -20,11 +46,13 @@ public:
         initial_length = (p2->position - p1->position).length();
     }
 
-    Constraint(Particle* p1, Particle* p2, float rest_length)
+    Constraint(Particle* p1, Particle* p2, float rest_length, ConstraintType type = ConstraintType::Structural, float stiffness = 1.0f)
         : p1(p1)
         , p2(p2)
         , initial_length(rest_length)
         , active(true)
+        , type(type)
+        , stiffness(stiffness)
     {
         if (initial_length <= 0) {
             initial_length = (p2->position - p1->position).length();
@@ -33,22 +61,30 @@ public:
         }
     }
 
-    void satisfy()
+    // 投影一次距离约束，返回投影前的相对长度误差 |L - L0| / L0
+    // relaxation 为松弛因子，>1 时为超松弛（SOR）
+    float satisfy(float relaxation = 1.0f)
     {
         if (!active)
-            return;
+            return 0.0f;
+        return project(*p1, *p2, initial_length, stiffness, relaxation);
+    }
 
-        Vector3f delta = p2->position - p1->position;
+    // 按静止长度投影一对粒子；规则网格的隐式扫描不经过约束数组，直接调用它
+    static float project(Particle& a, Particle& b, float rest_length, float stiffness, float relaxation)
+    {
+        Vector3f delta = b.position - a.position;
         float current_length = delta.length();
         if (current_length == 0)
-            return;
-        float difference = (current_length - initial_length) / current_length;
-        Vector3f correction = delta * 0.5f * difference;
-
-        if (!p1->is_pinned)
-            p1->position += correction;
-        if (!p2->is_pinned)
-            p2->position -= correction;
+            return 0.0f;
+        float difference = (current_length - rest_length) / current_length;
+        Vector3f correction = delta * (0.5f * difference * stiffness * relaxation);
+
+        if (!a.is_pinned)
+            a.position += correction;
+        if (!b.is_pinned)
+            b.position -= correction;
+        return std::abs(current_length - rest_length) / rest_length;
     }
 
     void deactivate()
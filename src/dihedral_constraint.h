@@ -0,0 +1,96 @@
+#ifndef DIHEDRAL_CONSTRAINT_H
+#define DIHEDRAL_CONSTRAINT_H
+
+#include "particle.h"
+#include <algorithm>
+#include <cmath>
+
+// 二面角弯曲约束：边 (p1, p2) 两侧三角形 (p1, p2, p3) 与 (p1, p2, p4) 的夹角保持静止值
+// 投影公式见 Müller et al., "Position Based Dynamics" 附录
+class DihedralConstraint {
+public:
+    Particle* p1;
+    Particle* p2;
+    Particle* p3;
+    Particle* p4;
+    float rest_angle;
+    float stiffness;
+    bool active;
+
+    DihedralConstraint(Particle* p1, Particle* p2, Particle* p3, Particle* p4, float rest_angle, float stiffness = 1.0f)
+        : p1(p1)
+        , p2(p2)
+        , p3(p3)
+        , p4(p4)
+        , rest_angle(rest_angle)
+        , stiffness(stiffness)
+        , active(true)
+    {
+    }
+
+    // 由四个点的位置计算二面角（两法线夹角）
+    static float angle(const Vector3f& x1, const Vector3f& x2, const Vector3f& x3, const Vector3f& x4)
+    {
+        Vector3f e = x2 - x1;
+        Vector3f n1 = e.cross(x3 - x1).normalized();
+        Vector3f n2 = e.cross(x4 - x1).normalized();
+        return std::acos(std::clamp(n1.dot(n2), -1.0f, 1.0f));
+    }
+
+    void satisfy(float relaxation = 1.0f)
+    {
+        if (!active)
+            return;
+        Vector3f x2 = p2->position - p1->position;
+        Vector3f x3 = p3->position - p1->position;
+        Vector3f x4 = p4->position - p1->position;
+        Vector3f c23 = x2.cross(x3);
+        Vector3f c24 = x2.cross(x4);
+        float l23 = c23.length();
+        float l24 = c24.length();
+        if (l23 < 1e-6f || l24 < 1e-6f)
+            return;
+        Vector3f n1 = c23 * (1.0f / l23);
+        Vector3f n2 = c24 * (1.0f / l24);
+        float d = std::clamp(n1.dot(n2), -1.0f, 1.0f);
+        float phi = std::acos(d);
+        float c = phi - rest_angle;
+        if (std::abs(c) < 1e-6f)
+            return;
+
+        Vector3f q3 = (x2.cross(n2) + n1.cross(x2) * d) * (1.0f / l23);
+        Vector3f q4 = (x2.cross(n1) + n2.cross(x2) * d) * (1.0f / l24);
+        Vector3f q2 = (x3.cross(n2) + n1.cross(x3) * d) * (-1.0f / l23) - (x4.cross(n1) + n2.cross(x4) * d) * (1.0f / l24);
+        Vector3f q1 = (q2 + q3 + q4) * -1.0f;
+
+        float w1 = p1->is_pinned ? 0.0f : 1.0f;
+        float w2 = p2->is_pinned ? 0.0f : 1.0f;
+        float w3 = p3->is_pinned ? 0.0f : 1.0f;
+        float w4 = p4->is_pinned ? 0.0f : 1.0f;
+        float denom = w1 * q1.dot(q1) + w2 * q2.dot(q2) + w3 * q3.dot(q3) + w4 * q4.dot(q4);
+        if (denom < 1e-12f)
+            return;
+        float s = -std::sqrt(std::max(0.0f, 1.0f - d * d)) * c / denom * stiffness * relaxation;
+        // 接近完全折叠或完全展平时梯度趋于零，s 会被放大；把单次位移限制在边长的四分之一以内
+        float max_q = std::sqrt(std::max({ w1 * q1.dot(q1), w2 * q2.dot(q2), w3 * q3.dot(q3), w4 * q4.dot(q4) }));
+        float limit = 0.25f * x2.length();
+        if (std::abs(s) * max_q > limit)
+            s = std::copysign(limit / max_q, s);
+        p1->position += q1 * (s * w1);
+        p2->position += q2 * (s * w2);
+        p3->position += q3 * (s * w3);
+        p4->position += q4 * (s * w4);
+    }
+
+    bool uses(const Particle* p) const
+    {
+        return p1 == p || p2 == p || p3 == p || p4 == p;
+    }
+
+    void deactivate()
+    {
+        active = false;
+    }
+};
+
+#endif // DIHEDRAL_CONSTRAINT_H
@@ -0,0 +1,217 @@
+#include "ensemble.h"
+#include "grid_topology.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+const size_t LANE_BLOCK = CACHE_LINE / sizeof(float); // 一条缓存行上的成员数
+const size_t MIN_BLOCKS = 1; // 每个线程至少处理的缓存行数
+}
+
+Ensemble::Ensemble(int rows_, int cols_, std::vector<EnsembleParams> params_)
+    : rows(rows_)
+    , cols(cols_)
+    , members(params_.size())
+    , stride((members + LANE_BLOCK - 1) / LANE_BLOCK * LANE_BLOCK)
+    , params(std::move(params_))
+    , metrics(members)
+{
+    // 拓扑与 reset_cloth 的正方形网格相同（单位间距），静止长度随成员间距缩放
+    std::vector<Particle> ps;
+    std::vector<Constraint> cs;
+    std::vector<DihedralConstraint> ds;
+    BendingOptions options;
+    options.dihedral = false;
+    GridPlacement placement;
+    placement.pin_top_row = true;
+    build_grid(GridType::Square, rows, cols, 1.0f, placement, ps, cs, ds, options);
+    links.reserve(cs.size());
+    for (const auto& c : cs) {
+        links.push_back({ static_cast<uint32_t>(c.p1 - ps.data()), static_cast<uint32_t>(c.p2 - ps.data()),
+            c.initial_length, c.stiffness, c.type == ConstraintType::Structural });
+    }
+    pinned.resize(ps.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+        pinned[i] = ps[i].is_pinned;
+
+    const size_t n = ps.size() * stride;
+    for (auto* v : { &x, &y, &z, &px, &py, &pz, &y0 })
+        v->resize(n);
+    for (auto* v : { &rest, &gravity, &wind, &max_speed, &strain, &mask })
+        v->resize(members);
+    for (size_t k = 0; k < members; ++k) {
+        rest[k] = params[k].rest_distance;
+        gravity[k] = params[k].gravity;
+        wind[k] = params[k].wind;
+        max_iterations = std::max(max_iterations, params[k].iterations);
+    }
+
+    // 竖直悬挂的布料，带少量 z 扰动
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const size_t base = static_cast<size_t>(r * cols + c) * stride;
+            const float perturb = static_cast<float>(c + r) / (rows + cols);
+            for (size_t k = 0; k < members; ++k) {
+                x[base + k] = px[base + k] = c * rest[k];
+                y[base + k] = py[base + k] = y0[base + k] = -r * rest[k];
+                z[base + k] = pz[base + k] = perturb * rest[k];
+            }
+        }
+    }
+}
+
+void Ensemble::integrate(size_t begin, size_t end, float time_step)
+{
+    const float dt2 = time_step * time_step;
+    const size_t count = pinned.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (pinned[i])
+            continue;
+        const size_t base = i * stride;
+        for (size_t k = begin; k < end; ++k) {
+            const size_t j = base + k;
+            float nx = x[j] + (x[j] - px[j]) + wind[k] * dt2;
+            float ny = y[j] + (y[j] - py[j]) - gravity[k] * dt2;
+            float nz = z[j] + (z[j] - pz[j]);
+            px[j] = x[j];
+            py[j] = y[j];
+            pz[j] = z[j];
+            x[j] = nx;
+            y[j] = ny;
+            z[j] = nz;
+        }
+    }
+}
+
+// 一条约束在 [begin, end) 个成员上的投影，与 Constraint::satisfy 相同。
+// 两端位于不同的粒子行，成员区间互不重叠，故可声明为不别名，循环沿成员向量化
+static void project_link(float* __restrict xa, float* __restrict ya, float* __restrict za,
+    float* __restrict xb, float* __restrict yb, float* __restrict zb,
+    const float* __restrict rest, const float* __restrict mask, float rest_scale, float half_stiffness,
+    float wa, float wb, size_t begin, size_t end)
+{
+    for (size_t k = begin; k < end; ++k) {
+        float dx = xb[k] - xa[k];
+        float dy = yb[k] - ya[k];
+        float dz = zb[k] - za[k];
+        float len = std::sqrt(dx * dx + dy * dy + dz * dz);
+        // len 为 0 时两点重合，分子同样为 0
+        float s = half_stiffness * mask[k] * (len - rest_scale * rest[k]) / std::max(len, 1e-12f);
+        xa[k] += dx * s * wa;
+        ya[k] += dy * s * wa;
+        za[k] += dz * s * wa;
+        xb[k] -= dx * s * wb;
+        yb[k] -= dy * s * wb;
+        zb[k] -= dz * s * wb;
+    }
+}
+
+// 迭代次数不同的成员用 0/1 权重屏蔽，循环内不分支
+void Ensemble::project(size_t begin, size_t end)
+{
+    for (int it = 0; it < max_iterations; ++it) {
+        for (size_t k = begin; k < end; ++k)
+            mask[k] = it < params[k].iterations ? 1.0f : 0.0f;
+        for (const Link& l : links) {
+            project_link(x.data() + l.a * stride, y.data() + l.a * stride, z.data() + l.a * stride,
+                x.data() + l.b * stride, y.data() + l.b * stride, z.data() + l.b * stride,
+                rest.data(), mask.data(), l.rest_scale, 0.5f * l.stiffness,
+                pinned[l.a] ? 0.0f : 1.0f, pinned[l.b] ? 0.0f : 1.0f, begin, end);
+        }
+    }
+}
+
+void Ensemble::measure(size_t begin, size_t end, float time_step)
+{
+    const float inv_h = 1.0f / time_step;
+    for (size_t k = begin; k < end; ++k) {
+        max_speed[k] = 0.0f;
+        strain[k] = 0.0f;
+    }
+    for (size_t i = 0; i < pinned.size(); ++i) {
+        const size_t base = i * stride;
+        for (size_t k = begin; k < end; ++k) {
+            const size_t j = base + k;
+            float vx = x[j] - px[j], vy = y[j] - py[j], vz = z[j] - pz[j];
+            max_speed[k] = std::max(max_speed[k], std::sqrt(vx * vx + vy * vy + vz * vz) * inv_h);
+        }
+    }
+    for (const Link& l : links) {
+        if (!l.structural)
+            continue;
+        const size_t a = l.a * stride, b = l.b * stride;
+        for (size_t k = begin; k < end; ++k) {
+            float dx = x[b + k] - x[a + k];
+            float dy = y[b + k] - y[a + k];
+            float dz = z[b + k] - z[a + k];
+            float target = l.rest_scale * rest[k];
+            float e = std::abs(std::sqrt(dx * dx + dy * dy + dz * dz) - target) / target;
+            strain[k] = std::max(strain[k], e);
+        }
+    }
+}
+
+template <typename Fn>
+void Ensemble::for_member_chunks(Fn&& fn)
+{
+    const size_t blocks = stride / LANE_BLOCK;
+    parallel_for_chunks(blocks, MIN_BLOCKS, [&](size_t, size_t first, size_t last) {
+        fn(first * LANE_BLOCK, std::min(last * LANE_BLOCK, members));
+    });
+}
+
+void Ensemble::step(float time_step)
+{
+    // 成员之间互不依赖，按成员区间分给各线程，每个线程在自己的通道区间上完成整步
+    for_member_chunks([&](size_t begin, size_t end) {
+        integrate(begin, end, time_step);
+        project(begin, end);
+    });
+}
+
+void Ensemble::run(int steps, float time_step, float settle_speed)
+{
+    std::vector<int, CacheAlignedAllocator<int>> last_moving(members, -1);
+    for_member_chunks([&](size_t begin, size_t end) {
+        for (int s = 0; s < steps; ++s) {
+            integrate(begin, end, time_step);
+            project(begin, end);
+            measure(begin, end, time_step);
+            for (size_t k = begin; k < end; ++k) {
+                if (max_speed[k] > settle_speed)
+                    last_moving[k] = s;
+                metrics[k].peak_strain = std::max(metrics[k].peak_strain, strain[k]);
+                metrics[k].max_strain = strain[k];
+            }
+        }
+    });
+
+    const float inv_h = 1.0f / time_step;
+    for (size_t k = 0; k < members; ++k) {
+        float energy = 0.0f;
+        for (size_t i = 0; i < pinned.size(); ++i) {
+            const size_t j = i * stride + k;
+            float vx = (x[j] - px[j]) * inv_h, vy = (y[j] - py[j]) * inv_h, vz = (z[j] - pz[j]) * inv_h;
+            energy += 0.5f * (vx * vx + vy * vy + vz * vz) + gravity[k] * (y[j] - y0[j]);
+        }
+        metrics[k].energy = energy;
+        metrics[k].settle_time = last_moving[k] < steps - 1 ? (last_moving[k] + 1) * time_step : -1.0f;
+    }
+}
+
+bool Ensemble::write_csv(const std::string& filename) const
+{
+    std::ofstream ofs(filename);
+    if (!ofs)
+        return false;
+    ofs << "member,gravity,wind,rest_distance,iterations,max_strain,peak_strain,energy,settle_time\n";
+    for (size_t k = 0; k < members; ++k) {
+        const EnsembleParams& p = params[k];
+        const EnsembleMetrics& m = metrics[k];
+        ofs << k << "," << p.gravity << "," << p.wind << "," << p.rest_distance << "," << p.iterations << ","
+            << m.max_strain << "," << m.peak_strain << "," << m.energy << "," << m.settle_time << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "parallel.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 集合中一个成员的参数
+struct EnsembleParams {
+    float gravity;
+    float wind;
+    float rest_distance;
+    int iterations;
+};
+
+// 一个成员的运行结果
+struct EnsembleMetrics {
+    float max_strain = 0.0f; // 结束时结构约束的最大相对伸长
+    float peak_strain = 0.0f; // 全程出现过的最大相对伸长
+    float energy = 0.0f; // 结束时的动能 + 相对初始位置的重力势能（单位质量）
+    float settle_time = -1.0f; // 最大速度此后一直低于阈值的时刻，-1 表示未静止
+};
+
+// 同一拓扑、不同参数的多块布料同步推进（无界面，用于参数扫描）。
+// 数据按 SoA 存放，下标为 粒子 * stride + 成员：同一粒子在各成员中的坐标相邻，
+// 约束循环的最内层沿成员展开，编译器可以把成员映射到 SIMD 通道。
+// stride 是成员数向上取到一条缓存行（16 个 float）的整数倍，数组按缓存行对齐，
+// 线程按 16 个成员的整数倍分块，各线程在每一行上写的通道不共享缓存行。
+class Ensemble {
+public:
+    Ensemble(int rows, int cols, std::vector<EnsembleParams> params);
+
+    // 推进一步：Verlet 积分 + 各成员各自迭代次数的 Gauss-Seidel 约束投影
+    void step(float time_step);
+    // 推进 steps 步并统计指标
+    void run(int steps, float time_step, float settle_speed);
+
+    size_t size() const { return members; }
+    const std::vector<EnsembleParams>& get_params() const { return params; }
+    const std::vector<EnsembleMetrics>& get_metrics() const { return metrics; }
+    bool write_csv(const std::string& filename) const;
+
+private:
+    struct Link {
+        uint32_t a, b; // 粒子下标
+        float rest_scale; // 静止长度 = rest_scale * 成员的粒子间距
+        float stiffness;
+        bool structural; // 只有结构约束计入伸长统计
+    };
+
+    // 按缓存行对齐的按成员数组
+    using LaneVector = std::vector<float, CacheAlignedAllocator<float>>;
+
+    int rows, cols;
+    size_t members;
+    size_t stride; // 每个粒子在 SoA 数组中占的长度
+    std::vector<EnsembleParams> params;
+    std::vector<EnsembleMetrics> metrics;
+    std::vector<Link> links;
+    std::vector<uint8_t> pinned; // 每个粒子，所有成员相同
+
+    LaneVector x, y, z; // 当前位置
+    LaneVector px, py, pz; // 上一步位置
+    LaneVector y0; // 初始高度，用于势能
+    LaneVector rest, gravity, wind; // 按成员展开的参数
+    LaneVector max_speed; // 本步各成员的最大速度
+    LaneVector strain; // 本步各成员的最大伸长
+    LaneVector mask; // 投影时本轮迭代各成员的 0/1 权重
+    int max_iterations = 0;
+
+    // fn(begin, end)：按成员区间并行，区间边界是 16 的整数倍
+    template <typename Fn>
+    void for_member_chunks(Fn&& fn);
+
+    void integrate(size_t begin, size_t end, float time_step);
+    void project(size_t begin, size_t end);
+    void measure(size_t begin, size_t end, float time_step);
+};
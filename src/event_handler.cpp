@@ -1,11 +1,12 @@
 #include "event_handler.h"
 #include "constants.h" // For key codes, potentially
+#include <algorithm>   // For std::max
 #include <iostream>    // For save/load messages
 
 EventHandler::EventHandler(SimulationManager &sim, Camera &cam,
                            sf::RenderWindow &win)
     : sim_manager_(sim), camera_(cam), window_(win), dragging_(false),
-      dragged_particle_(nullptr), dragged_particle_initial_cam_z_(0.0f),
+      dragged_index_(-1), dragged_particle_initial_cam_z_(0.0f),
       display_info_message_(false) {}
 
 Particle *EventHandler::findNearestParticle(const sf::Vector2i &mouse_pos,
@@ -39,6 +40,10 @@ Particle *EventHandler::findNearestParticle(const sf::Vector2i &mouse_pos,
     return nearest;
 }
 
+int EventHandler::particleIndex(const Particle *particle) const {
+    return static_cast<int>(particle - sim_manager_.getParticles().data());
+}
+
 Vector3f EventHandler::screenToWorld(const sf::Vector2i &mouse_pos,
                                      float target_cam_z,
                                      float current_win_width,
@@ -104,24 +109,42 @@ void EventHandler::handleKeyPressed(const sf::Event::KeyEvent &key_event) {
     case sf::Keyboard::Key::X:
         sim_manager_.setTearMode(true);
         break;
-    case sf::Keyboard::Key::Space:
-        sim_manager_.toggleWind();
+    // Simulation edits go through the command queue and take effect at the
+    // next step boundary
+    case sf::Keyboard::Key::Space: {
+        bool on = !sim_manager_.isWindOn();
+        float strength = sim_manager_.getWindStrength();
+        sim_manager_.submit({.type = InputEventType::Wind,
+                             .index = on,
+                             .value = !on ? 0.0f
+                                          : (strength == 0.0f ? 100.0f
+                                                              : strength)});
         break;
+    }
     case sf::Keyboard::Key::R:
-        sim_manager_.resetCloth();
+        sim_manager_.submit(
+            {.type = InputEventType::Reset,
+             .value = static_cast<float>(sim_manager_.getGridType())});
         break;
     case sf::Keyboard::Key::Equal: // Plus key
-        sim_manager_.setGravity(sim_manager_.getGravity() + 1.0f);
+        sim_manager_.submit({.type = InputEventType::Gravity,
+                             .value = sim_manager_.getGravity() + 1.0f});
         break;
     case sf::Keyboard::Key::Hyphen: // Minus key
-        sim_manager_.setGravity(sim_manager_.getGravity() - 1.0f);
+        sim_manager_.submit({.type = InputEventType::Gravity,
+                             .value = sim_manager_.getGravity() - 1.0f});
         break;
     case sf::Keyboard::Key::LBracket:
-        sim_manager_.adjustWindStrength(-10.0f);
-        break;
-    case sf::Keyboard::Key::RBracket:
-        sim_manager_.adjustWindStrength(10.0f);
+    case sf::Keyboard::Key::RBracket: {
+        float delta =
+            key_event.code == sf::Keyboard::Key::LBracket ? -10.0f : 10.0f;
+        float strength =
+            std::max(0.0f, sim_manager_.getWindStrength() + delta);
+        sim_manager_.submit({.type = InputEventType::Wind,
+                             .index = sim_manager_.isWindOn() || strength > 0,
+                             .value = strength});
         break;
+    }
     case sf::Keyboard::Key::A:
         camera_.adjustYaw(-0.05f);
         camera_updated = true;
@@ -142,13 +165,16 @@ void EventHandler::handleKeyPressed(const sf::Event::KeyEvent &key_event) {
         }
         break;
     case sf::Keyboard::Key::T:
-        sim_manager_.setGridType(GridType::Triangle);
+        sim_manager_.submit({.type = InputEventType::Reset,
+                             .value = static_cast<float>(GridType::Triangle)});
         break;
     case sf::Keyboard::Key::H:
-        sim_manager_.setGridType(GridType::Hexagon);
+        sim_manager_.submit({.type = InputEventType::Reset,
+                             .value = static_cast<float>(GridType::Hexagon)});
         break;
     case sf::Keyboard::Key::Q:
-        sim_manager_.setGridType(GridType::Square);
+        sim_manager_.submit({.type = InputEventType::Reset,
+                             .value = static_cast<float>(GridType::Square)});
         break;
     case sf::Keyboard::Key::I:
         display_info_message_ = !display_info_message_;
@@ -163,7 +189,7 @@ void EventHandler::handleKeyPressed(const sf::Event::KeyEvent &key_event) {
     case sf::Keyboard::Key::L:
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl) ||
             sf::Keyboard::isKeyPressed(sf::Keyboard::RControl)) {
-            sim_manager_.loadState("cloth_save.txt");
+            sim_manager_.submit({.type = InputEventType::Load});
         }
         break;
     default:
@@ -182,13 +208,14 @@ void EventHandler::handleMouseButtonPressed(
             findNearestParticle(mouse_event.position, current_win_width,
                                 current_win_height, camera_);
         if (sim_manager_.isTearMode() && nearest) {
-            sim_manager_.handleParticleTear(nearest);
+            sim_manager_.submit({.type = InputEventType::Tear,
+                                 .index = particleIndex(nearest)});
         } else {
             if (nearest && !nearest->is_pinned) {
                 dragging_ = true;
-                dragged_particle_ = nearest;
-                Vector3f initial_cam_coords = camera_.worldToCameraCoordinates(
-                    dragged_particle_->position);
+                dragged_index_ = particleIndex(nearest);
+                Vector3f initial_cam_coords =
+                    camera_.worldToCameraCoordinates(nearest->position);
                 dragged_particle_initial_cam_z_ = initial_cam_coords.z;
                 if (dragged_particle_initial_cam_z_ <= 0.1f)
                     dragged_particle_initial_cam_z_ =
@@ -200,7 +227,8 @@ void EventHandler::handleMouseButtonPressed(
             findNearestParticle(mouse_event.position, current_win_width,
                                 current_win_height, camera_);
         if (nearest) {
-            nearest->is_pinned = !nearest->is_pinned;
+            sim_manager_.submit({.type = InputEventType::Pin,
+                                 .index = particleIndex(nearest)});
         }
     } else if (mouse_event.button == sf::Mouse::Middle) {
         // Panning logic would go here if re-enabled
@@ -214,7 +242,7 @@ void EventHandler::handleMouseButtonReleased(
     const sf::Event::MouseButtonEvent &mouse_event) {
     if (mouse_event.button == sf::Mouse::Left) {
         dragging_ = false;
-        dragged_particle_ = nullptr;
+        dragged_index_ = -1;
     }
     // if (mouse_event.button == sf::Mouse::Middle) {
     //     panning_ = false;
@@ -232,15 +260,15 @@ void EventHandler::handleMouseWheelScrolled(
 void EventHandler::updateMouseDrag(float current_win_width,
                                    float current_win_height,
                                    const Camera &camera) {
-    if (dragging_ && dragged_particle_) {
+    if (dragging_ && dragged_index_ >= 0) {
         sf::Vector2i mousePos = sf::Mouse::getPosition(
             window_); // Use the window reference passed in constructor
         Vector3f new_world_pos =
             screenToWorld(mousePos, dragged_particle_initial_cam_z_,
                           current_win_width, current_win_height, camera);
 
-        dragged_particle_->position = new_world_pos;
-        dragged_particle_->previous_position =
-            new_world_pos; // Avoid velocity jump
+        sim_manager_.submit({.type = InputEventType::DragMove,
+                             .index = dragged_index_,
+                             .position = new_world_pos});
     }
 }
\ No newline at end of file
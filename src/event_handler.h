@@ -31,7 +31,7 @@ class EventHandler {
 
     // Interaction states
     bool dragging_;
-    Particle *dragged_particle_;
+    int dragged_index_; // Particles are addressed by index in edit commands
     float dragged_particle_initial_cam_z_;
 
     // Panning state (currently disabled in main.cpp, but kept for structure)
@@ -55,6 +55,7 @@ class EventHandler {
                                   float current_win_height,
                                   const Camera &camera,
                                   float threshold_sq = (30.0f * 30.0f));
+    int particleIndex(const Particle *particle) const;
     Vector3f screenToWorld(const sf::Vector2i &mouse_pos, float target_cam_z,
                            float current_win_width, float current_win_height,
                            const Camera &camera);
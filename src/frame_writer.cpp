@@ -0,0 +1,71 @@
+#include "frame_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+FrameWriter::FrameWriter(std::string directory, std::string prefix, int width, int height, size_t max_pending)
+    : directory(std::move(directory))
+    , prefix(std::move(prefix))
+    , width(width)
+    , height(height)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(this->directory, ec);
+    usable = !ec;
+    const size_t bytes = static_cast<size_t>(width) * height * 3;
+    for (size_t i = 0; i < std::max<size_t>(max_pending, 1); ++i) {
+        buffers.push_back(std::make_unique<uint8_t[]>(bytes));
+        free_buffers.push_back(buffers.back().get());
+    }
+}
+
+FrameWriter::~FrameWriter()
+{
+    finish();
+}
+
+std::span<uint8_t> FrameWriter::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (free_buffers.empty()) {
+        ++acquire_stalls;
+        returned.wait(lock, [this] { return !free_buffers.empty(); });
+    }
+    uint8_t* buffer = free_buffers.back();
+    free_buffers.pop_back();
+    return { buffer, static_cast<size_t>(width) * height * 3 };
+}
+
+void FrameWriter::submit(std::span<uint8_t> frame, int index)
+{
+    TaskScheduler::instance().async(pending, [this, buffer = frame.data(), index] {
+        if (write(buffer, index))
+            ++frames_written;
+        else
+            ++frames_failed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            free_buffers.push_back(buffer);
+        }
+        returned.notify_one();
+    });
+}
+
+void FrameWriter::finish()
+{
+    TaskScheduler::instance().wait(pending);
+}
+
+bool FrameWriter::write(const uint8_t* rgb, int index) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%05d.ppm", index);
+    std::ofstream ofs(std::filesystem::path(directory) / (prefix + name), std::ios::binary);
+    if (!ofs)
+        return false;
+    ofs << "P6\n"
+        << width << " " << height << "\n255\n";
+    ofs.write(reinterpret_cast<const char*>(rgb), static_cast<std::streamsize>(width) * height * 3);
+    return static_cast<bool>(ofs);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "task_scheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+// 把渲染好的帧写成编号的二进制 PPM 图像（directory/prefix00000.ppm ...）。
+// 写盘作为后台任务交给 TaskScheduler，模拟和渲染不等它；帧缓冲区来自固定大小的池，
+// 只有 max_pending 帧都还没写完时 acquire 才会等待，内存占用有上限
+class FrameWriter {
+public:
+    FrameWriter(std::string directory, std::string prefix, int width, int height, size_t max_pending);
+    ~FrameWriter();
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // 目录创建失败时为 false
+    bool ok() const { return usable; }
+
+    // 取一块空闲的帧缓冲区（width * height * 3 字节 RGB）
+    std::span<uint8_t> acquire();
+    // 把 acquire 得到的缓冲区写成第 index 帧，写完后缓冲区回到池中
+    void submit(std::span<uint8_t> frame, int index);
+    // 等待已提交的帧全部写完
+    void finish();
+
+    size_t written() const { return frames_written.load(); }
+    size_t failed() const { return frames_failed.load(); }
+    // acquire 因缓冲区用尽而等待的次数
+    size_t stalls() const { return acquire_stalls; }
+
+private:
+    std::string directory, prefix;
+    int width, height;
+    bool usable = false;
+    std::vector<std::unique_ptr<uint8_t[]>> buffers;
+    std::vector<uint8_t*> free_buffers;
+    std::mutex mutex;
+    std::condition_variable returned;
+    TaskGroup pending;
+    std::atomic<size_t> frames_written { 0 }, frames_failed { 0 };
+    size_t acquire_stalls = 0;
+
+    bool write(const uint8_t* rgb, int index) const;
+};
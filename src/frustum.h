@@ -0,0 +1,105 @@
+#pragma once
+#include "constants.h"
+#include "vector3f.h"
+#include <cstdint>
+
+// 屏幕坐标（像素），可直接转换为 sf::Vector2f 等二维向量类型；不依赖 SFML，无界面工具也能用
+struct ScreenPoint {
+    float x, y;
+
+    template <typename Vec2>
+    operator Vec2() const { return Vec2(x, y); }
+};
+
+struct Rgb {
+    uint8_t r, g, b;
+};
+
+// 软件光栅化与表面网格输出的屏幕空间顶点
+struct ScreenVertex {
+    ScreenPoint position;
+    Rgb color;
+};
+
+// 透视相机的视锥：世界坐标 -> 相机坐标 -> 屏幕坐标，以及点相对视锥各平面的外码。
+// 相机坐标系中相机看向 +Z，屏幕原点在左上角
+struct ViewFrustum {
+    // 外码的各位：点在对应平面之外
+    enum Outcode : uint8_t {
+        Near = 1,
+        Left = 2,
+        Right = 4,
+        Top = 8,
+        Bottom = 16
+    };
+
+    Vector3f eye; // 相机位置
+    Vector3f right, up, forward; // 相机坐标轴（世界坐标）
+    float focal; // 焦距（像素）
+    float half_width, half_height; // 屏幕半宽、半高（像素）
+
+    // 相机位于 eye、看向 target
+    static ViewFrustum look_at(const Vector3f& eye, const Vector3f& target, const Vector3f& world_up, float focal, float width, float height)
+    {
+        ViewFrustum f;
+        Vector3f back = (eye - target).normalized();
+        f.eye = eye;
+        f.right = world_up.cross(back).normalized();
+        f.up = back.cross(f.right);
+        f.forward = back * -1.0f;
+        f.focal = focal;
+        f.half_width = width * 0.5f;
+        f.half_height = height * 0.5f;
+        return f;
+    }
+
+    Vector3f to_camera(const Vector3f& p) const
+    {
+        Vector3f d = p - eye;
+        return Vector3f(d.dot(right), d.dot(up), d.dot(forward));
+    }
+
+    // 侧面四个平面过相机位置，用齐次形式判断，近平面后方的点也能得到正确的侧面外码
+    uint8_t outcode(const Vector3f& c) const
+    {
+        uint8_t code = 0;
+        if (c.z <= CAMERA_NEAR)
+            code |= Near;
+        if (c.x * focal < -half_width * c.z)
+            code |= Left;
+        if (c.x * focal > half_width * c.z)
+            code |= Right;
+        if (c.y * focal > half_height * c.z)
+            code |= Top;
+        if (c.y * focal < -half_height * c.z)
+            code |= Bottom;
+        return code;
+    }
+
+    // 只对近平面前方的点有意义
+    ScreenPoint to_screen(const Vector3f& c) const
+    {
+        float inv_z = 1.0f / c.z;
+        return { c.x * focal * inv_z + half_width, -c.y * focal * inv_z + half_height };
+    }
+
+    // 把线段裁剪到近平面前方再投影到屏幕。两端在同一平面外（整段不可见）时返回 false；
+    // 侧面不裁剪，交给光栅化
+    bool clip_segment(Vector3f a, uint8_t code_a, Vector3f b, uint8_t code_b, ScreenPoint& screen_a, ScreenPoint& screen_b) const
+    {
+        if (code_a & code_b)
+            return false;
+        if ((code_a | code_b) & Near) {
+            float t = (CAMERA_NEAR - a.z) / (b.z - a.z);
+            Vector3f hit = a + (b - a) * t;
+            hit.z = CAMERA_NEAR; // 避免舍入落回近平面后方
+            if (code_a & Near)
+                a = hit;
+            else
+                b = hit;
+        }
+        screen_a = to_screen(a);
+        screen_b = to_screen(b);
+        return true;
+    }
+};
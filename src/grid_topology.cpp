@@ -0,0 +1,251 @@
+#include "grid_topology.h"
+#include "particle_rebind.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+// 每组 { dr, dc, dc_odd, row_mod, row_phase, col_mod, col_phase }
+// 方格、三角形：右、下各按列/行奇偶分两色；两条对角线各按行奇偶分两色（三角形网格关闭剪切时归入结构约束）
+constexpr GridStencil SQUARE_STRUCTURAL[] = {
+    { 0, 1, 1, 1, 0, 2, 0 }, { 0, 1, 1, 1, 0, 2, 1 }, // 右
+    { 1, 0, 0, 2, 0, 1, 0 }, { 1, 0, 0, 2, 1, 1, 0 }, // 下
+};
+constexpr GridStencil TRIANGLE_STRUCTURAL[] = {
+    { 0, 1, 1, 1, 0, 2, 0 }, { 0, 1, 1, 1, 0, 2, 1 }, // 右
+    { 1, 0, 0, 2, 0, 1, 0 }, { 1, 0, 0, 2, 1, 1, 0 }, // 下
+    { 1, 1, 1, 2, 0, 1, 0 }, { 1, 1, 1, 2, 1, 1, 0 }, // 右下
+    { 1, -1, -1, 2, 0, 1, 0 }, { 1, -1, -1, 2, 1, 1, 0 }, // 左下
+};
+constexpr GridStencil SQUARE_SHEAR[] = {
+    { 1, 1, 1, 2, 0, 1, 0 }, { 1, 1, 1, 2, 1, 1, 0 }, // 右下
+    { 1, -1, -1, 2, 0, 1, 0 }, { 1, -1, -1, 2, 1, 1, 0 }, // 左下
+};
+// 隔点弯曲：跳过一个粒子，按列/行模 4 分四色
+constexpr GridStencil SQUARE_BENDING[] = {
+    { 0, 2, 2, 1, 0, 4, 0 }, { 0, 2, 2, 1, 0, 4, 1 }, { 0, 2, 2, 1, 0, 4, 2 }, { 0, 2, 2, 1, 0, 4, 3 },
+    { 2, 0, 0, 4, 0, 1, 0 }, { 2, 0, 0, 4, 1, 1, 0 }, { 2, 0, 0, 4, 2, 1, 0 }, { 2, 0, 0, 4, 3, 1, 0 },
+};
+// 六边形（三角点阵）：奇数行右移半格，左下、右下的列偏移随行奇偶变化
+constexpr GridStencil HEXAGON_STRUCTURAL[] = {
+    { 0, 1, 1, 1, 0, 2, 0 }, { 0, 1, 1, 1, 0, 2, 1 }, // 右
+    { 1, 0, -1, 2, 0, 1, 0 }, { 1, 0, -1, 2, 1, 1, 0 }, // 左下
+    { 1, 1, 0, 2, 0, 1, 0 }, { 1, 1, 0, 2, 1, 1, 0 }, // 右下
+};
+// 剪切：菱形的长对角线，即次近邻（正下方隔一行、右下和左下各隔一列半）
+constexpr GridStencil HEXAGON_SHEAR[] = {
+    { 2, 0, 0, 4, 0, 1, 0 }, { 2, 0, 0, 4, 1, 1, 0 }, { 2, 0, 0, 4, 2, 1, 0 }, { 2, 0, 0, 4, 3, 1, 0 },
+    { 1, 1, 2, 2, 0, 1, 0 }, { 1, 1, 2, 2, 1, 1, 0 },
+    { 1, -2, -1, 2, 0, 1, 0 }, { 1, -2, -1, 2, 1, 1, 0 },
+};
+}
+
+std::span<const GridStencil> grid_stencils(GridType type, ConstraintType constraint_type)
+{
+    switch (constraint_type) {
+    case ConstraintType::Structural:
+        return type == GridType::Square ? std::span<const GridStencil>(SQUARE_STRUCTURAL)
+            : type == GridType::Triangle ? std::span<const GridStencil>(TRIANGLE_STRUCTURAL)
+                                         : std::span<const GridStencil>(HEXAGON_STRUCTURAL);
+    case ConstraintType::Shear:
+        return type == GridType::Hexagon ? std::span<const GridStencil>(HEXAGON_SHEAR) : std::span<const GridStencil>(SQUARE_SHEAR);
+    default:
+        return SQUARE_BENDING;
+    }
+}
+
+Vector3f grid_rest_position(GridType type, int row, int col, float rest_distance)
+{
+    if (type == GridType::Hexagon) {
+        float hex_dx = rest_distance * 0.866f;
+        float hex_dy = rest_distance * 0.75f;
+        return Vector3f(col * hex_dx + (row % 2) * (hex_dx / 2), row * hex_dy, 0);
+    }
+    return Vector3f(col * rest_distance, row * rest_distance, 0);
+}
+
+std::vector<int> grid_triangles(GridType type, int rows, int cols)
+{
+    std::vector<int> tris;
+    tris.reserve(static_cast<size_t>(std::max(rows - 1, 0)) * std::max(cols - 1, 0) * 6);
+    for (int r = 0; r < rows - 1; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int i = r * cols + c;
+            if (type != GridType::Hexagon) {
+                if (c < cols - 1) {
+                    tris.insert(tris.end(), { i, i + 1, i + cols + 1 });
+                    tris.insert(tris.end(), { i, i + cols + 1, i + cols });
+                }
+            } else if (r % 2 == 0) { // 偶数行向右下连接
+                if (c < cols - 1) {
+                    tris.insert(tris.end(), { i, i + cols + 1, i + cols });
+                    tris.insert(tris.end(), { i, i + 1, i + cols + 1 });
+                }
+            } else { // 奇数行向左下连接
+                if (c > 0)
+                    tris.insert(tris.end(), { i, i + cols, i + cols - 1 });
+                if (c < cols - 1)
+                    tris.insert(tris.end(), { i, i + 1, i + cols });
+            }
+        }
+    }
+    return tris;
+}
+
+namespace {
+struct GridKey {
+    GridType type;
+    int rows, cols;
+    float rest_distance;
+    BendingOptions options;
+
+    bool operator==(const GridKey&) const = default;
+};
+
+// 平面静止位置上生成好的一块网格，粒子未固定
+struct CachedGrid {
+    GridKey key;
+    std::vector<Particle> particles;
+    std::vector<Constraint> constraints;
+    std::vector<DihedralConstraint> dihedrals;
+};
+
+std::shared_ptr<const CachedGrid> generate(const GridKey& key)
+{
+    const GridType type = key.type;
+    const int rows = key.rows, cols = key.cols;
+    const BendingOptions& options = key.options;
+    const size_t n = static_cast<size_t>(rows) * cols;
+    auto grid = std::make_shared<CachedGrid>();
+    grid->key = key;
+
+    grid->particles.reserve(n);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            Vector3f p = grid_rest_position(type, r, c, key.rest_distance);
+            grid->particles.emplace_back(p.x, p.y, 0.0f);
+        }
+    }
+    if (rows < 2 || cols < 2)
+        return grid;
+
+    // 距离约束：按类别、颜色逐组枚举，组内行优先，静止长度取自静止位置。
+    // 方格、三角形的表里 dc_odd == dc，统一按六边形的规则枚举即可
+    std::array<std::span<const GridStencil>, CONSTRAINT_TYPE_COUNT> groups;
+    std::array<float, CONSTRAINT_TYPE_COUNT> stiffness = { 1.0f, options.shear_stiffness, options.bending_stiffness };
+    for (int t = 0; t < CONSTRAINT_TYPE_COUNT; ++t)
+        groups[t] = grid_stencils(type, static_cast<ConstraintType>(t));
+    const int shear = static_cast<int>(ConstraintType::Shear), bending = static_cast<int>(ConstraintType::Bending);
+    if (!options.shear)
+        groups[shear] = {};
+    else if (type == GridType::Triangle)
+        groups[0] = groups[0].first(4); // 对角线按剪切约束处理
+    if (!options.bending)
+        groups[bending] = {};
+
+    size_t count = 0;
+    for (const auto& stencils : groups) {
+        for (const GridStencil& s : stencils) {
+            for (int k = 0; k < s.row_count(rows); ++k)
+                count += stencil_row<GridType::Hexagon>(s, k, cols).count(s.col_mod);
+        }
+    }
+    auto rest = [&](int i) { return grid->particles[i].position; };
+    grid->constraints.reserve(count);
+    for (int t = 0; t < CONSTRAINT_TYPE_COUNT; ++t) {
+        for (size_t color = 0; color < groups[t].size(); ++color) {
+            const GridStencil& s = groups[t][color];
+            for_each_stencil_edge<GridType::Hexagon>(s, cols, 0, s.row_count(rows), [&](int i, int j) {
+                grid->constraints.emplace_back(&grid->particles[i], &grid->particles[j], (rest(j) - rest(i)).length(),
+                    static_cast<ConstraintType>(t), stiffness[t]);
+                grid->constraints.back().color = static_cast<uint8_t>(color);
+            });
+        }
+    }
+
+    // 二面角弯曲：三角形内部边两侧的对顶点
+    if (options.dihedral) {
+        struct EdgeInfo {
+            int opposite;
+            bool paired;
+        };
+        std::vector<int> tris = grid_triangles(type, rows, cols);
+        std::unordered_map<uint64_t, EdgeInfo> edges;
+        edges.reserve(tris.size());
+        grid->dihedrals.reserve(tris.size() / 2);
+        for (size_t t = 0; t < tris.size(); t += 3) {
+            for (int k = 0; k < 3; ++k) {
+                int a = tris[t + k], b = tris[t + (k + 1) % 3], opp = tris[t + (k + 2) % 3];
+                uint64_t edge = (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint32_t>(std::max(a, b));
+                auto [it, inserted] = edges.try_emplace(edge, EdgeInfo { opp, false });
+                if (inserted || it->second.paired)
+                    continue;
+                it->second.paired = true;
+                const int c = it->second.opposite;
+                float rest_angle = DihedralConstraint::angle(rest(a), rest(b), rest(c), rest(opp));
+                grid->dihedrals.emplace_back(&grid->particles[a], &grid->particles[b], &grid->particles[c], &grid->particles[opp],
+                    rest_angle, options.dihedral_stiffness);
+            }
+        }
+    }
+    return grid;
+}
+
+// 最近用过的几种网格；各网格之间互不影响，返回的共享指针在淘汰后仍然有效
+std::shared_ptr<const CachedGrid> cached_grid(const GridKey& key)
+{
+    static std::mutex mutex;
+    static std::vector<std::shared_ptr<const CachedGrid>> cache; // 末尾为最近使用
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& g) { return g->key == key; });
+    std::shared_ptr<const CachedGrid> grid;
+    if (it != cache.end()) {
+        grid = *it;
+        cache.erase(it);
+    } else {
+        grid = generate(key);
+        if (cache.size() >= static_cast<size_t>(GRID_CACHE_SIZE))
+            cache.erase(cache.begin());
+    }
+    cache.push_back(grid);
+    return grid;
+}
+}
+
+void build_grid(GridType type, int rows, int cols, float rest_distance, const GridPlacement& placement,
+    std::vector<Particle>& particles, std::vector<Constraint>& constraints, std::vector<DihedralConstraint>& dihedrals,
+    const BendingOptions& options)
+{
+    std::shared_ptr<const CachedGrid> grid = cached_grid({ type, std::max(rows, 0), std::max(cols, 0), rest_distance, options });
+    const size_t n = grid->particles.size();
+
+    particles.assign(grid->particles.begin(), grid->particles.end());
+    constraints.assign(grid->constraints.begin(), grid->constraints.end());
+    dihedrals.assign(grid->dihedrals.begin(), grid->dihedrals.end());
+    rebind_particles(constraints, grid->particles.data(), n, particles.data());
+    rebind_particles(dihedrals, grid->particles.data(), n, particles.data());
+
+    const float ramp = rows + cols > 0 ? placement.depth_ramp / (rows + cols) : 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const int r = static_cast<int>(i / cols), c = static_cast<int>(i % cols);
+        const Vector3f rest = particles[i].position;
+        const Vector3f p = placement.origin + placement.right * rest.x + placement.down * rest.y + Vector3f(0, 0, ramp * (r + c));
+        particles[i].position = p;
+        particles[i].previous_position = p;
+        particles[i].is_pinned = placement.pin_top_row && r == 0;
+    }
+}
+
+std::vector<ConstraintBatch> constraint_batches(std::span<const Constraint> constraints)
+{
+    std::vector<ConstraintBatch> batches;
+    for (size_t i = 0; i < constraints.size(); ++i) {
+        if (batches.empty() || batches.back().type != constraints[i].type || batches.back().color != constraints[i].color)
+            batches.push_back({ constraints[i].type, constraints[i].color, i, i });
+        batches.back().end = i + 1;
+    }
+    return batches;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "constants.h"
+#include "constraint.h"
+#include "dihedral_constraint.h"
+#include "particle.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 网格类型
+enum class GridType { Square,
+    Triangle,
+    Hexagon };
+
+inline const char* grid_type_name(GridType type)
+{
+    switch (type) {
+    case GridType::Square:
+        return "Square";
+    case GridType::Triangle:
+        return "Triangle";
+    default:
+        return "Hexagon";
+    }
+}
+
+// 附加约束的开关与刚度
+struct BendingOptions {
+    bool shear = true;
+    float shear_stiffness = SHEAR_STIFFNESS;
+    bool bending = true; // 隔点弯曲（距离约束）
+    float bending_stiffness = BENDING_STIFFNESS;
+    bool dihedral = true; // 二面角弯曲
+    float dihedral_stiffness = DIHEDRAL_STIFFNESS;
+
+    bool operator==(const BendingOptions&) const = default;
+};
+
+// 网格的摆放：第 r 行第 c 列的粒子位于 origin + right * x + down * y，(x, y) 为平面静止位置；
+// 另可沿对角线加一点 z 扰动，避免布料初始完全共面
+struct GridPlacement {
+    Vector3f origin;
+    Vector3f right { 1, 0, 0 };
+    Vector3f down { 0, 1, 0 };
+    float depth_ramp = 0.0f; // z += (r + c) / (rows + cols) * depth_ramp
+    bool pin_top_row = false;
+};
+
+// 约束批次：constraints[begin, end) 的类别和颜色相同
+struct ConstraintBatch {
+    ConstraintType type;
+    uint8_t color;
+    size_t begin, end;
+};
+
+// 规则网格上的一组同向同色约束：第 r 行第 c 列的粒子连到第 r + dr 行第 c + dc 列，
+// 六边形网格的奇数行错开半格，改用 dc_odd（其余网格两者相同）。
+// 只取 r % row_mod == row_phase、c % col_mod == col_phase 且两端都在网格内的粒子对，按行优先排列；
+// 组内的约束两两不共用粒子
+struct GridStencil {
+    int dr, dc, dc_odd;
+    int row_mod, row_phase;
+    int col_mod, col_phase;
+
+    // 参与的行数，第 k 个参与行为 row_phase + k * row_mod
+    int row_count(int rows) const
+    {
+        const int last = rows - dr;
+        return last > row_phase ? (last - row_phase + row_mod - 1) / row_mod : 0;
+    }
+};
+
+// 一个参与行内的粒子对：起点下标 [begin, end)，步长 col_mod，另一端为起点 + offset
+struct StencilRow {
+    int begin, end, offset;
+
+    int count(int step) const { return begin < end ? (end - begin + step - 1) / step : 0; }
+};
+
+// 第 slot 个参与行；G 为六边形时奇数行换用 dc_odd，其余网格在编译期去掉这一分支
+template <GridType G>
+StencilRow stencil_row(const GridStencil& s, int slot, int cols)
+{
+    const int r = s.row_phase + slot * s.row_mod;
+    const int dc = (G == GridType::Hexagon && (r & 1)) ? s.dc_odd : s.dc;
+    int c = std::max(0, -dc);
+    c += ((s.col_phase - c) % s.col_mod + s.col_mod) % s.col_mod;
+    return { r * cols + c, r * cols + std::min(cols, cols - dc), s.dr * cols + dc };
+}
+
+// 按行优先顺序枚举第 [slot_begin, slot_end) 个参与行内的粒子对 fn(i, j)
+template <GridType G, typename Fn>
+void for_each_stencil_edge(const GridStencil& s, int cols, int slot_begin, int slot_end, Fn&& fn)
+{
+    for (int k = slot_begin; k < slot_end; ++k) {
+        const StencilRow row = stencil_row<G>(s, k, cols);
+        for (int i = row.begin; i < row.end; i += s.col_mod)
+            fn(i, i + row.offset);
+    }
+}
+
+// 某类约束在规则网格上的全部同色组，下标即颜色。
+// 三角形网格的对角线在关闭剪切时归入结构约束，即结构约束的第 4 种颜色起
+std::span<const GridStencil> grid_stencils(GridType type, ConstraintType constraint_type);
+
+// 规则网格在平面静止状态下的位置（与生成网格时的排布一致）
+Vector3f grid_rest_position(GridType type, int row, int col, float rest_distance);
+
+// 网格的三角化，每三个粒子下标组成一个三角形
+std::vector<int> grid_triangles(GridType type, int rows, int cols);
+
+// 生成 rows x cols 的规则网格布料：粒子行优先排列；结构、剪切、隔点弯曲约束各成一批，
+// 批内按 grid_stencils 的顺序分成同色组、组内按行优先顺序排列；另含二面角约束。
+// 拓扑按 (type, rows, cols, rest_distance, options) 缓存在平面静止位置上，
+// 再次生成同一网格只需复制数组、平移约束指针并按 placement 摆放粒子
+void build_grid(GridType type, int rows, int cols, float rest_distance, const GridPlacement& placement,
+    std::vector<Particle>& particles, std::vector<Constraint>& constraints, std::vector<DihedralConstraint>& dihedrals,
+    const BendingOptions& options = BendingOptions());
+
+// 按类别和颜色切分（已排序的）约束数组
+std::vector<ConstraintBatch> constraint_batches(std::span<const Constraint> constraints);
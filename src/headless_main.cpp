@@ -0,0 +1,493 @@
+// 无界面的命令行工具：批量参数扫描、离屏渲染等，不依赖 SFML
+#include "cloth_state.h"
+#include "constants.h"
+#include "ensemble.h"
+#include "frame_writer.h"
+#include "parallel.h"
+#include "regression.h"
+#include "render_snapshot.h"
+#include "scene.h"
+#include "software_raster.h"
+#include "solver.h"
+#include "strain_color.h"
+#include "surface_mesh.h"
+#include "task_scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 取值范围：单个数 "v" 或等分的 "from:to:count"
+struct Range {
+    float from, to;
+    int count;
+
+    float at(int i) const { return count > 1 ? from + (to - from) * i / (count - 1) : from; }
+};
+
+bool parse_range(const std::string& text, Range& out)
+{
+    char* end = nullptr;
+    out.from = std::strtof(text.c_str(), &end);
+    out.to = out.from;
+    out.count = 1;
+    if (*end == '\0')
+        return true;
+    if (*end != ':')
+        return false;
+    out.to = std::strtof(end + 1, &end);
+    if (*end != ':')
+        return false;
+    out.count = std::atoi(end + 1);
+    return out.count > 0;
+}
+
+void print_usage()
+{
+    std::cerr << "Usage:\n"
+                 "  cloth_headless ensemble [options]\n"
+                 "    --gravity R       gravity (default "
+              << GRAVITY_CONST << ")\n"
+                 "    --wind R          wind strength (default 0)\n"
+                 "    --rest R          rest distance (default "
+              << DEFAULT_REST_DISTANCE << ")\n"
+                 "    --iterations R    solver iterations (default "
+              << MAX_SOLVER_ITER << ")\n"
+                 "    --rows N --cols N grid size (default 30 x 30)\n"
+                 "    --steps N         steps to simulate (default 600)\n"
+                 "    --out FILE        CSV output (default ensemble.csv)\n"
+                 "  R is a single value or from:to:count; the ensemble is the Cartesian product.\n"
+                 "  cloth_headless regress [options]\n"
+                 "    --scenario NAME   pinned_sheet, wind_flag, tear, stocking, hex_sheet or all (default all)\n"
+                 "    --frames N        frames per scenario (default "
+              << REGRESSION_FRAMES << ")\n"
+                 "    --iterations N    solver iterations (default "
+              << MAX_SOLVER_ITER << ")\n"
+                 "    --save FILE       saved cloth for the stocking scenario (default cloth_save.txt)\n"
+                 "    --shipped         run the live solver with its shipped settings instead of\n"
+                 "                      the reference-equivalent ones (early exit, tethers, batch rates)\n"
+                 "    --multigrid       solve the coarse grid levels first on regular grids\n"
+                 "    --rms-tol X --error-tol X --energy-tol X   per-frame tolerances\n"
+                 "    --final-error-tol X --energy-bound X   tolerances with --shipped or --multigrid:\n"
+                 "                      final structural error over the reference, and max |energy|\n"
+                 "                      as a multiple of the reference's\n"
+                 "    --out FILE        per-frame CSV (optional)\n"
+                 "  Exits with status 1 if any scenario exceeds a tolerance.\n"
+                 "  cloth_headless render [options]\n"
+                 "    --scene NAME      flag, curtain or stadium (default flag)\n"
+                 "    --load FILE       simulate a saved cloth instead (drawn as wireframe)\n"
+                 "    --rows N --cols N flag/curtain size (default 30 x 40)\n"
+                 "    --flags N         stadium flag count (default "
+              << STADIUM_FLAGS << ")\n"
+                 "    --frames N        frames to render (default 300)\n"
+                 "    --width N --height N   image size (default 1280 x 720)\n"
+                 "    --wind X          wind strength (default 20)\n"
+                 "    --yaw DEG --pitch DEG  camera orbit angles (default 30, 15)\n"
+                 "    --distance X      camera distance (default: fit the cloth)\n"
+                 "    --wireframe       draw constraints as lines instead of the shaded surface\n"
+                 "    --queue N         frames buffered for background writing (default 8)\n"
+                 "    --out DIR         output directory for frame_00000.ppm ... (default frames)\n"
+                 "Common options:\n"
+                 "  --workers N         worker threads (default: cores - 1, or $CLOTH_WORKERS)\n"
+                 "  --pin-cores         pin worker i to core i + 1 (or $CLOTH_PIN_CORES=1)\n";
+}
+
+int run_ensemble(int argc, char** argv)
+{
+    Range gravity { GRAVITY_CONST, GRAVITY_CONST, 1 };
+    Range wind { 0, 0, 1 };
+    Range rest { DEFAULT_REST_DISTANCE, DEFAULT_REST_DISTANCE, 1 };
+    Range iterations { MAX_SOLVER_ITER, MAX_SOLVER_ITER, 1 };
+    int rows = 30, cols = 30, steps = 600;
+    std::string out = "ensemble.csv";
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            print_usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--gravity")
+            ok = parse_range(value, gravity);
+        else if (arg == "--wind")
+            ok = parse_range(value, wind);
+        else if (arg == "--rest")
+            ok = parse_range(value, rest);
+        else if (arg == "--iterations")
+            ok = parse_range(value, iterations);
+        else if (arg == "--rows")
+            rows = std::atoi(value.c_str());
+        else if (arg == "--cols")
+            cols = std::atoi(value.c_str());
+        else if (arg == "--steps")
+            steps = std::atoi(value.c_str());
+        else if (arg == "--out")
+            out = value;
+        else
+            ok = false;
+        if (!ok || rows < 2 || cols < 2 || steps < 1) {
+            std::cerr << "Bad argument: " << arg << " " << value << "\n";
+            print_usage();
+            return 2;
+        }
+    }
+
+    std::vector<EnsembleParams> params;
+    for (int g = 0; g < gravity.count; ++g)
+        for (int w = 0; w < wind.count; ++w)
+            for (int r = 0; r < rest.count; ++r)
+                for (int it = 0; it < iterations.count; ++it)
+                    params.push_back({ gravity.at(g), wind.at(w), rest.at(r), std::max(1, static_cast<int>(std::lround(iterations.at(it)))) });
+
+    auto start = std::chrono::steady_clock::now();
+    Ensemble ensemble(rows, cols, std::move(params));
+    ensemble.run(steps, TIME_STEP, ENSEMBLE_SETTLE_SPEED);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!ensemble.write_csv(out)) {
+        std::cerr << "Failed to write " << out << "\n";
+        return 1;
+    }
+    std::cout << ensemble.size() << " members, " << rows << "x" << cols << ", " << steps << " steps in "
+              << seconds << " s -> " << out << "\n";
+    return 0;
+}
+
+// 冻结的参考实现与现行求解器逐帧对照，超出容差时返回 1
+int run_regress(int argc, char** argv)
+{
+    std::vector<RegressionScenario> scenarios;
+    int frames = REGRESSION_FRAMES;
+    int iterations = MAX_SOLVER_ITER;
+    bool shipped = false;
+    bool multigrid = false;
+    std::string save_file = "cloth_save.txt";
+    std::string out;
+    RegressionTolerances tolerances;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shipped") {
+            shipped = true;
+            continue;
+        }
+        if (arg == "--multigrid") {
+            multigrid = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--scenario") {
+            ok = value == "all";
+            for (int s = 0; s < REGRESSION_SCENARIO_COUNT; ++s) {
+                auto scenario = static_cast<RegressionScenario>(s);
+                if (value == regression_scenario_name(scenario)) {
+                    scenarios.push_back(scenario);
+                    ok = true;
+                }
+            }
+        } else if (arg == "--frames")
+            frames = std::atoi(value.c_str());
+        else if (arg == "--iterations")
+            iterations = std::atoi(value.c_str());
+        else if (arg == "--save")
+            save_file = value;
+        else if (arg == "--out")
+            out = value;
+        else if (arg == "--rms-tol")
+            tolerances.position_rms = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--error-tol")
+            tolerances.constraint_error = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--energy-tol")
+            tolerances.energy_drift = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--final-error-tol")
+            tolerances.final_error = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--energy-bound")
+            tolerances.energy_bound = std::strtof(value.c_str(), nullptr);
+        else
+            ok = false;
+        if (!ok || frames < 1 || iterations < 1) {
+            std::cerr << "Bad argument: " << arg << " " << value << "\n";
+            print_usage();
+            return 2;
+        }
+    }
+    if (scenarios.empty()) {
+        for (int s = 0; s < REGRESSION_SCENARIO_COUNT; ++s)
+            scenarios.push_back(static_cast<RegressionScenario>(s));
+    }
+
+    // 默认让现行求解器走与参考实现等价的路径：固定迭代次数、每轮扫描全部批次、无附着约束，
+    // 此时与基线的偏差来自实现本身的改动（运算顺序、刚度与松弛路径等），由逐帧容差判定
+    SolverSettings settings;
+    if (!shipped) {
+        settings.tolerance = 0.0f;
+        settings.relaxation = 1.0f;
+        settings.acceleration = SolverAcceleration::None;
+        settings.multigrid = false;
+        settings.tethers = false;
+        settings.batch_period.fill(1);
+    }
+    if (multigrid)
+        settings.multigrid = true;
+    settings.max_iterations = iterations;
+    // 发行设置或多重网格走的是另一条轨迹，逐帧对照没有意义
+    RegressionMode mode = shipped || multigrid ? RegressionMode::Shipped : RegressionMode::PerFrame;
+
+    std::vector<RegressionResult> results;
+    bool all_passed = true;
+    for (auto scenario : scenarios) {
+        RegressionResult result;
+        if (!run_regression(scenario, settings, mode, frames, tolerances, save_file, result)) {
+            std::cerr << regression_scenario_name(scenario) << ": failed to load " << save_file << "\n";
+            all_passed = false;
+            continue;
+        }
+        std::cout << regression_scenario_name(scenario);
+        if (mode == RegressionMode::PerFrame)
+            std::cout << ": position rms " << result.max_position_rms << ", error excess " << result.max_error_excess
+                      << ", energy drift " << result.max_energy_drift;
+        else
+            std::cout << ": final error excess " << result.final_error_excess << ", energy ratio "
+                      << result.energy_ratio;
+        if (result.passed())
+            std::cout << " -> PASS\n";
+        else
+            std::cout << " -> FAIL (frame " << result.first_failure << ")\n";
+        all_passed = all_passed && result.passed();
+        results.push_back(std::move(result));
+    }
+
+    if (!out.empty() && !write_regression_csv(results, out)) {
+        std::cerr << "Failed to write " << out << "\n";
+        return 1;
+    }
+    return all_passed ? 0 : 1;
+}
+
+
+// 场景线框：与窗口程序相同的视锥剔除、近平面裁剪和按应变着色
+void build_wireframe(const RenderSnapshot& snapshot, const ViewFrustum& frustum, std::vector<Vector3f>& camera,
+    std::vector<uint8_t>& outcodes, std::vector<ScreenVertex>& out)
+{
+    const size_t n = snapshot.positions.size();
+    camera.resize(n);
+    outcodes.resize(n);
+    parallel_for(n, 2048, [&](size_t i) {
+        camera[i] = frustum.to_camera(snapshot.positions[i]);
+        outcodes[i] = frustum.outcode(camera[i]);
+    });
+    parallel_compact(snapshot.lines.size(), 2048, 2, out, [&](size_t k, ScreenVertex* dst) -> size_t {
+        const RenderSnapshot::Line& l = snapshot.lines[k];
+        ScreenPoint a, b;
+        if (!frustum.clip_segment(camera[l.a], outcodes[l.a], camera[l.b], outcodes[l.b], a, b))
+            return 0;
+        const Rgb color = strain_color(l.strain);
+        dst[0] = { a, color };
+        dst[1] = { b, color };
+        return 2;
+    });
+}
+
+// 离屏渲染：无界面地推进模拟，每帧用软件光栅化画成图像，由后台任务写成 PPM 序列
+int run_render(int argc, char** argv)
+{
+    std::string scene_name = "flag", load_file, out_dir = "frames";
+    int frames = 300, width = 1280, height = 720, rows = 30, cols = 40, flags = STADIUM_FLAGS, queue = 8;
+    float wind = 20.0f, yaw = 30.0f, pitch = 15.0f, distance = 0.0f;
+    bool wireframe = false;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--wireframe") {
+            wireframe = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--scene") {
+            ok = value == "flag" || value == "curtain" || value == "stadium";
+            scene_name = value;
+        } else if (arg == "--load")
+            load_file = value;
+        else if (arg == "--rows")
+            rows = std::atoi(value.c_str());
+        else if (arg == "--cols")
+            cols = std::atoi(value.c_str());
+        else if (arg == "--flags")
+            flags = std::atoi(value.c_str());
+        else if (arg == "--frames")
+            frames = std::atoi(value.c_str());
+        else if (arg == "--width")
+            width = std::atoi(value.c_str());
+        else if (arg == "--height")
+            height = std::atoi(value.c_str());
+        else if (arg == "--wind")
+            wind = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--yaw")
+            yaw = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--pitch")
+            pitch = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--distance")
+            distance = std::strtof(value.c_str(), nullptr);
+        else if (arg == "--queue")
+            queue = std::atoi(value.c_str());
+        else if (arg == "--out")
+            out_dir = value;
+        else
+            ok = false;
+        if (!ok || rows < 2 || cols < 2 || flags < 1 || frames < 1 || width < 16 || height < 16 || queue < 1) {
+            std::cerr << "Bad argument: " << arg << " " << value << "\n";
+            print_usage();
+            return 2;
+        }
+    }
+
+    // 模拟：场景，或从存档加载的单块布料（没有规则网格，只能画线框）
+    Scene scene;
+    std::vector<Particle> loaded_particles;
+    std::vector<Constraint> loaded_constraints;
+    ConstraintSolver loaded_solver;
+    std::vector<float> loaded_strain;
+    const bool loaded = !load_file.empty();
+    if (loaded) {
+        if (!ClothState::load(loaded_particles, loaded_constraints, load_file) || loaded_particles.empty()) {
+            std::cerr << "Failed to load " << load_file << "\n";
+            return 1;
+        }
+        wireframe = true;
+    } else if (scene_name == "stadium") {
+        scene.build_stadium(flags);
+    } else if (scene_name == "curtain") {
+        scene.add_curtain(Vector3f(0, 0, 0), Vector3f(1, 0, 0), rows, cols, DEFAULT_REST_DISTANCE);
+    } else {
+        scene.add_flag(Vector3f(0, 0, 0), Vector3f(1, 0, 0), rows, cols, DEFAULT_REST_DISTANCE);
+    }
+    auto particles = [&]() -> const std::vector<Particle>& { return loaded ? loaded_particles : scene.get_particles(); };
+    auto constraints = [&]() -> const std::vector<Constraint>& { return loaded ? loaded_constraints : scene.get_constraints(); };
+    auto step = [&] {
+        if (!loaded) {
+            scene.step(GRAVITY_CONST, wind, TIME_STEP);
+            return;
+        }
+        for (auto& p : loaded_particles) {
+            p.apply_force(Vector3f(wind, -GRAVITY_CONST, 0));
+            p.update(TIME_STEP);
+            p.constrain_to_bounds(WIDTH, HEIGHT, 1000.0f);
+        }
+        loaded_strain.resize(loaded_constraints.size());
+        loaded_solver.solve(loaded_particles, loaded_constraints, {}, loaded_strain);
+    };
+
+    // 相机绕初始包围盒中心，默认距离让整块布料落在画面中
+    Vector3f lo = particles().front().position, hi = lo;
+    for (const auto& p : particles()) {
+        lo = Vector3f(std::min(lo.x, p.position.x), std::min(lo.y, p.position.y), std::min(lo.z, p.position.z));
+        hi = Vector3f(std::max(hi.x, p.position.x), std::max(hi.y, p.position.y), std::max(hi.z, p.position.z));
+    }
+    const Vector3f center = (lo + hi) * 0.5f;
+    const float radius = std::max((hi - lo).length() * 0.5f, 1.0f);
+    const float focal = height * 0.9f;
+    if (distance <= 0.0f)
+        distance = radius * focal / (0.4f * std::min(width, height)) + radius;
+    const float yaw_rad = yaw * std::numbers::pi_v<float> / 180.0f, pitch_rad = pitch * std::numbers::pi_v<float> / 180.0f;
+    const Vector3f eye = center + Vector3f(std::sin(yaw_rad) * std::cos(pitch_rad), std::sin(pitch_rad), std::cos(yaw_rad) * std::cos(pitch_rad)) * distance;
+    const ViewFrustum frustum = ViewFrustum::look_at(eye, center, Vector3f(0, 1, 0), focal, static_cast<float>(width), static_cast<float>(height));
+
+    FrameWriter writer(out_dir, "frame_", width, height, static_cast<size_t>(queue));
+    if (!writer.ok()) {
+        std::cerr << "Cannot create " << out_dir << "\n";
+        return 1;
+    }
+    RenderSnapshot snapshot;
+    SurfaceMesh surface;
+    std::vector<RenderGrid> grids;
+    std::vector<ScreenVertex> vertices;
+    std::vector<Vector3f> camera;
+    std::vector<uint8_t> outcodes;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        step();
+        snapshot.capture(particles(), constraints(), loaded ? std::span<const float>(loaded_strain) : scene.get_strain());
+        grids.clear();
+        for (const auto& inst : scene.get_instances())
+            grids.push_back({ inst.first_particle, inst.rows, inst.cols, inst.spacing, GridType::Square, inst.shape == ClothShape::Stocking });
+
+        SoftwareRaster raster(writer.acquire(), width, height);
+        raster.clear({ 0, 0, 0 });
+        if (!wireframe && surface.set_grids(grids, snapshot.positions.size())) {
+            surface.build(snapshot.positions, frustum, vertices);
+            raster.draw_triangles(vertices);
+        } else {
+            build_wireframe(snapshot, frustum, camera, outcodes, vertices);
+            raster.draw_lines(vertices);
+        }
+        writer.submit(raster.pixels(), f);
+    }
+    writer.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << writer.written() << " frames " << width << "x" << height << " in " << seconds << " s -> " << out_dir
+              << " (" << writer.stalls() << " waits for the writer";
+    if (writer.failed() > 0)
+        std::cout << ", " << writer.failed() << " failed";
+    std::cout << ")\n";
+    return writer.failed() > 0 ? 1 : 0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    // 通用选项：--workers N 和 --pin-cores 设置共用调度器，可出现在任意位置
+    std::vector<char*> args;
+    size_t workers = 0;
+    bool pin_cores = false;
+    bool configure = false;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workers" && i + 1 < argc) {
+            workers = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+            configure = true;
+        } else if (arg == "--pin-cores") {
+            pin_cores = true;
+            configure = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (configure)
+        TaskScheduler::instance().configure(workers, pin_cores);
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 2) {
+        print_usage();
+        return 2;
+    }
+    std::string command = argv[1];
+    if (command == "ensemble")
+        return run_ensemble(argc - 2, argv + 2);
+    if (command == "regress")
+        return run_regress(argc - 2, argv + 2);
+    if (command == "render")
+        return run_render(argc - 2, argv + 2);
+    print_usage();
+    return 2;
+}
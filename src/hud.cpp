@@ -0,0 +1,101 @@
+#include "hud.h"
+#include "constants.h"
+#include <algorithm>
+#include <charconv>
+
+HudLine& HudLine::operator<<(std::string_view text)
+{
+    size_t count = std::min(text.size(), buffer.size() - length);
+    std::copy_n(text.data(), count, buffer.data() + length);
+    length += count;
+    return *this;
+}
+
+HudLine& HudLine::operator<<(double value)
+{
+    auto result = std::to_chars(buffer.data() + length, buffer.data() + buffer.size(), value, std::chars_format::general, 4);
+    if (result.ec == std::errc())
+        length = result.ptr - buffer.data();
+    return *this;
+}
+
+HudLine& HudLine::operator<<(HudFixed value)
+{
+    auto result = std::to_chars(buffer.data() + length, buffer.data() + buffer.size(), value.value, std::chars_format::fixed, value.precision);
+    if (result.ec == std::errc())
+        length = result.ptr - buffer.data();
+    return *this;
+}
+
+HudLine& HudLine::append_integer(long long value)
+{
+    auto result = std::to_chars(buffer.data() + length, buffer.data() + buffer.size(), value);
+    if (result.ec == std::errc())
+        length = result.ptr - buffer.data();
+    return *this;
+}
+
+HudPanel::HudPanel(const sf::Font& font, unsigned character_size, sf::Color color)
+    : font(font)
+    , character_size(character_size)
+    , color(color)
+{
+}
+
+void HudPanel::set_line(size_t index, std::string_view text)
+{
+    if (index >= lines.size())
+        set_line_count(index + 1);
+    Line& line = lines[index];
+    if (line.text == text)
+        return;
+    line.text.assign(text); // 容量够时复用原有缓冲区
+    line.glyphs.setString(line.text);
+    width_dirty = true;
+}
+
+void HudPanel::set_line_count(size_t count)
+{
+    if (count < lines.size()) {
+        lines.erase(lines.begin() + count, lines.end());
+        width_dirty = true;
+        return;
+    }
+    while (lines.size() < count) {
+        lines.push_back({ std::string(), sf::Text(font, "", character_size) });
+        lines.back().glyphs.setFillColor(color);
+        layout_dirty = true;
+    }
+}
+
+float HudPanel::width()
+{
+    if (width_dirty) {
+        cached_width = 0.0f;
+        for (const auto& line : lines)
+            cached_width = std::max(cached_width, line.glyphs.getLocalBounds().size.x);
+        width_dirty = false;
+    }
+    return cached_width;
+}
+
+void HudPanel::draw(sf::RenderTarget& target, sf::Vector2f at)
+{
+    if (layout_dirty || at != position) {
+        position = at;
+        for (size_t i = 0; i < lines.size(); ++i)
+            lines[i].glyphs.setPosition(sf::Vector2f(position.x, position.y + i * line_height()));
+        layout_dirty = false;
+    }
+    for (const auto& line : lines)
+        target.draw(line.glyphs);
+}
+
+bool HudRefresh::due()
+{
+    if (!first && clock.getElapsedTime().asSeconds() < 1.0f / HUD_REFRESH_HZ)
+        return false;
+    first = false;
+    clock.restart();
+    return true;
+}
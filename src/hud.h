@@ -0,0 +1,83 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 按固定小数位输出的浮点数：line << HudFixed { fps, 1 }
+struct HudFixed {
+    double value;
+    int precision;
+};
+
+// 单行 HUD 文本的拼接缓冲区：定长数组，数值用 std::to_chars 格式化，不做内存分配。
+// 超出容量的部分会被截断
+class HudLine {
+public:
+    HudLine& clear()
+    {
+        length = 0;
+        return *this;
+    }
+    HudLine& operator<<(std::string_view text);
+    HudLine& operator<<(std::integral auto value) { return append_integer(static_cast<long long>(value)); }
+    // 浮点数按 4 位有效数字输出
+    HudLine& operator<<(double value);
+    HudLine& operator<<(HudFixed value);
+
+    std::string_view view() const { return { buffer.data(), length }; }
+
+private:
+    std::array<char, 128> buffer;
+    size_t length = 0;
+
+    HudLine& append_integer(long long value);
+};
+
+// 缓存的多行 HUD 面板：每行一个常驻的 sf::Text，只有内容变化的行才重新设置字符串、重排字形
+class HudPanel {
+public:
+    HudPanel(const sf::Font& font, unsigned character_size, sf::Color color);
+
+    // 设置第 index 行（不足时补行）；内容与上次相同时什么也不做
+    void set_line(size_t index, std::string_view text);
+    void set_line(size_t index, const HudLine& text) { set_line(index, text.view()); }
+    // 行数变少时丢弃多余的行
+    void set_line_count(size_t count);
+    size_t line_count() const { return lines.size(); }
+
+    float line_height() const { return character_size * 1.15f; }
+    float height() const { return lines.size() * line_height(); }
+    // 最宽一行的宽度，只在内容变化后重新测量
+    float width();
+
+    // position 是面板左上角，没有变化时不会重设各行位置
+    void draw(sf::RenderTarget& target, sf::Vector2f position);
+
+private:
+    struct Line {
+        std::string text;
+        sf::Text glyphs;
+    };
+    const sf::Font& font;
+    unsigned character_size;
+    sf::Color color;
+    std::vector<Line> lines;
+    sf::Vector2f position;
+    float cached_width = 0.0f;
+    bool width_dirty = true;
+    bool layout_dirty = true;
+};
+
+// 数值字段的刷新节流：每秒最多 HUD_REFRESH_HZ 次，避免数字每帧跳动、每帧重排字形
+class HudRefresh {
+public:
+    bool due();
+
+private:
+    sf::Clock clock;
+    bool first = true;
+};
@@ -0,0 +1,182 @@
+#include "implicit_integrator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t MIN_CHUNK = 4096; // 每个线程至少处理的粒子数
+
+float dot(const std::vector<Vector3f>& a, const std::vector<Vector3f>& b)
+{
+    return static_cast<float>(parallel_sum<double>(a.size(), MIN_CHUNK, [&](size_t i) { return static_cast<double>(a[i].dot(b[i])); }));
+}
+}
+
+// 由有效约束生成块稀疏结构，并记录每条弹簧对应的块位置
+void ImplicitIntegrator::build_pattern(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints, size_t active)
+{
+    const int n = static_cast<int>(particles.size());
+    const Particle* base = particles.data();
+    std::vector<std::vector<int>> neighbors(n);
+    for (const auto& c : constraints) {
+        if (!c.active)
+            continue;
+        int a = static_cast<int>(c.p1 - base);
+        int b = static_cast<int>(c.p2 - base);
+        neighbors[a].push_back(b);
+        neighbors[b].push_back(a);
+    }
+    row_offsets.assign(n + 1, 0);
+    columns.clear();
+    diagonal.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        auto& row = neighbors[i];
+        row.push_back(i);
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        for (int j : row) {
+            if (j == i)
+                diagonal[i] = static_cast<int>(columns.size());
+            columns.push_back(j);
+        }
+        row_offsets[i + 1] = static_cast<int>(columns.size());
+    }
+    auto slot = [&](int row, int col) {
+        auto first = columns.begin() + row_offsets[row];
+        auto last = columns.begin() + row_offsets[row + 1];
+        return static_cast<int>(std::lower_bound(first, last, col) - columns.begin());
+    };
+    springs.clear();
+    for (const auto& c : constraints) {
+        if (!c.active)
+            continue;
+        int a = static_cast<int>(c.p1 - base);
+        int b = static_cast<int>(c.p2 - base);
+        springs.push_back({ a, b, slot(a, b), slot(b, a), c.initial_length, c.stiffness });
+    }
+    blocks.assign(columns.size(), Matrix3f());
+
+    pattern_particles = particles.size();
+    pattern_constraints = constraints.size();
+    pattern_active = active;
+    pattern_dirty = false;
+}
+
+// y = A x，固定粒子所在行输出 0
+void ImplicitIntegrator::multiply(const std::vector<Vector3f>& x, std::vector<Vector3f>& y) const
+{
+    parallel_for(x.size(), MIN_CHUNK, [&](size_t i) {
+        Vector3f sum;
+        if (!fixed[i]) {
+            for (int k = row_offsets[i]; k < row_offsets[i + 1]; ++k)
+                sum += blocks[k] * x[columns[k]];
+        }
+        y[i] = sum;
+    });
+}
+
+// 块 Jacobi 预条件共轭梯度，求解 A dv = rhs
+int ImplicitIntegrator::solve_cg()
+{
+    const size_t n = rhs.size();
+    std::fill(dv.begin(), dv.end(), Vector3f());
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        residual[i] = rhs[i];
+        precond_residual[i] = precond[i] * residual[i];
+        direction[i] = precond_residual[i];
+    });
+    float rz = dot(residual, precond_residual);
+    const float target = cg_tolerance * cg_tolerance * dot(rhs, rhs);
+    int iter = 0;
+    for (; iter < max_cg_iterations; ++iter) {
+        if (dot(residual, residual) <= target)
+            break;
+        multiply(direction, product);
+        float pq = dot(direction, product);
+        if (pq <= 0)
+            break;
+        float alpha = rz / pq;
+        parallel_for(n, MIN_CHUNK, [&](size_t i) {
+            dv[i] += direction[i] * alpha;
+            residual[i] -= product[i] * alpha;
+            precond_residual[i] = precond[i] * residual[i];
+        });
+        float rz_new = dot(residual, precond_residual);
+        float beta = rz_new / rz;
+        rz = rz_new;
+        parallel_for(n, MIN_CHUNK, [&](size_t i) {
+            direction[i] = precond_residual[i] + direction[i] * beta;
+        });
+    }
+    return iter;
+}
+
+void ImplicitIntegrator::step(std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float h)
+{
+    const size_t n = particles.size();
+    size_t active = std::count_if(constraints.begin(), constraints.end(), [](const Constraint& c) { return c.active; });
+    // 计数只是兜底：数量不变的拓扑修改要靠调用方 invalidate()
+    if (pattern_dirty || n != pattern_particles || constraints.size() != pattern_constraints || active != pattern_active)
+        build_pattern(particles, constraints, active);
+
+    for (auto* v : { &velocity, &rhs, &dv, &residual, &direction, &product, &precond_residual })
+        v->resize(n);
+    precond.resize(n);
+    fixed.resize(n);
+
+    // 质量矩阵（单位质量）+ 阻尼项，外力
+    const float inv_h = 1.0f / h;
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        const Particle& p = particles[i];
+        fixed[i] = p.is_pinned;
+        velocity[i] = (p.position - p.previous_position) * inv_h;
+        for (int k = row_offsets[i]; k < row_offsets[i + 1]; ++k)
+            blocks[k] = Matrix3f();
+        blocks[diagonal[i]] = Matrix3f(1.0f + h * damping);
+        rhs[i] = (p.acceleration - velocity[i] * damping) * h;
+    });
+
+    // 弹簧力与刚度矩阵：A = M - h^2 K，rhs = h (f + h K v)
+    const float h2 = h * h;
+    for (const auto& s : springs) {
+        Vector3f d = particles[s.b].position - particles[s.a].position;
+        float len = d.length();
+        if (len == 0)
+            continue;
+        Vector3f dir = d * (1.0f / len);
+        Matrix3f nn = Matrix3f::outer(dir, dir);
+        // 压缩时丢弃横向项，保证矩阵正定
+        float lateral = std::max(0.0f, 1.0f - s.rest_length / len);
+        float k = stiffness * s.weight;
+        Matrix3f ks = (nn + (Matrix3f(1.0f) - nn) * lateral) * k;
+
+        Vector3f force = dir * (k * (len - s.rest_length)); // 作用在 a 上
+        Vector3f kv = ks * (velocity[s.b] - velocity[s.a]);
+        rhs[s.a] += (force + kv * h) * h;
+        rhs[s.b] -= (force + kv * h) * h;
+
+        Matrix3f hks = ks * h2;
+        blocks[diagonal[s.a]] += hks;
+        blocks[diagonal[s.b]] += hks;
+        blocks[s.ab] += hks * -1.0f;
+        blocks[s.ba] += hks * -1.0f;
+    }
+
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        if (fixed[i])
+            rhs[i] = Vector3f();
+        precond[i] = blocks[diagonal[i]].inverse();
+    });
+
+    last_cg_iterations = solve_cg();
+
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        Particle& p = particles[i];
+        if (!p.is_pinned) {
+            Vector3f v = velocity[i] + dv[i];
+            p.previous_position = p.position;
+            p.position += v * h;
+        }
+        p.acceleration = Vector3f(0, 0, 0);
+    });
+}
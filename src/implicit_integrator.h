@@ -0,0 +1,83 @@
+#pragma once
+#include "constants.h"
+#include "constraint.h"
+#include "matrix3f.h"
+#include "particle.h"
+#include <vector>
+
+// 时间积分方式
+enum class Integrator {
+    Verlet, // 显式 Verlet（Particle::update）
+    ImplicitEuler, // 隐式后向欧拉 + 共轭梯度
+    ProjectiveDynamics // 投影动力学（同时完成约束求解，见 projective_dynamics.h）
+};
+
+inline const char* integrator_name(Integrator integrator)
+{
+    switch (integrator) {
+    case Integrator::ImplicitEuler:
+        return "Implicit";
+    case Integrator::ProjectiveDynamics:
+        return "Projective";
+    default:
+        return "Verlet";
+    }
+}
+
+// 按 Verlet -> 隐式欧拉 -> 投影动力学 的顺序切换
+inline Integrator next_integrator(Integrator integrator)
+{
+    switch (integrator) {
+    case Integrator::Verlet:
+        return Integrator::ImplicitEuler;
+    case Integrator::ImplicitEuler:
+        return Integrator::ProjectiveDynamics;
+    default:
+        return Integrator::Verlet;
+    }
+}
+
+// Baraff-Witkin 风格的隐式后向欧拉积分器。
+// 把每条约束当作弹簧，组装 (M - h^2 K) Δv = h (f + h K v) 的块稀疏（3x3 块 CSR）系统，
+// 用块 Jacobi 预条件的共轭梯度多线程求解。稀疏结构按拓扑缓存，每帧只更新数值。
+class ImplicitIntegrator {
+public:
+    float stiffness = IMPLICIT_STIFFNESS; // 弹簧刚度（单位质量）
+    float damping = IMPLICIT_DAMPING; // 速度阻尼系数
+    int max_cg_iterations = IMPLICIT_CG_ITER;
+    float cg_tolerance = IMPLICIT_CG_TOLERANCE; // 相对残差
+
+    // 使用粒子上累积的 acceleration 作为外力，积分后清零（与 Particle::update 一致）
+    void step(std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float time_step);
+    // 拓扑变化（重置、加载、撕裂）后调用，下一步重建稀疏结构
+    void invalidate() { pattern_dirty = true; }
+
+    int get_last_cg_iterations() const { return last_cg_iterations; }
+
+private:
+    // 块 CSR：第 i 行的块位于 [row_offsets[i], row_offsets[i+1])
+    std::vector<int> row_offsets;
+    std::vector<int> columns;
+    std::vector<Matrix3f> blocks;
+    std::vector<int> diagonal; // 每行对角块的位置
+    struct SpringSlots {
+        int a, b; // 粒子下标
+        int ab, ba; // 非对角块位置
+        float rest_length;
+        float weight; // 约束自身的相对刚度
+    };
+    std::vector<SpringSlots> springs;
+    size_t pattern_particles = 0;
+    size_t pattern_constraints = 0;
+    size_t pattern_active = 0;
+    bool pattern_dirty = true;
+
+    std::vector<Vector3f> velocity, rhs, dv, residual, direction, product, precond_residual;
+    std::vector<Matrix3f> precond;
+    std::vector<char> fixed;
+    int last_cg_iterations = 0;
+
+    void build_pattern(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints, size_t active);
+    void multiply(const std::vector<Vector3f>& x, std::vector<Vector3f>& y) const;
+    int solve_cg();
+};
@@ -13,6 +13,14 @@ class InputHandler {
 public:
     static void handle_mouse_click(const sf::Event& event, std::vector<Particle>& particles,
         std::vector<Constraint>& constraints)
+    {
+        int index = constraint_at(event, constraints);
+        if (index >= 0)
+            constraints[index].deactivate();
+    }
+
+    // 左键点中的约束下标，没有则返回 -1（便于把撕裂记录成输入事件）
+    static int constraint_at(const sf::Event& event, const std::vector<Constraint>& constraints)
     {
         if (event.is<sf::Event::MouseButtonPressed>()) {
             const auto* mouse = event.getIf<sf::Event::MouseButtonPressed>();
@@ -20,9 +28,12 @@ public:
                 float mouse_x = static_cast<float>(mouse->position.x);
                 float mouse_y = static_cast<float>(mouse->position.y);
                 // 假设投影到z=0平面
-                tear_cloth(Vector3f(mouse_x, mouse_y, 0), particles, constraints);
+                Constraint* nearest = find_nearest_constraint(Vector3f(mouse_x, mouse_y, 0), constraints);
+                if (nearest)
+                    return static_cast<int>(nearest - constraints.data());
             }
         }
+        return -1;
     }
 
 private:
@@ -53,15 +64,6 @@ private:
         }
         return nearest_constraint;
     }
-
-    static void tear_cloth(const Vector3f& mouse_pos, const std::vector<Particle>& particles,
-        std::vector<Constraint>& constraints)
-    {
-        Constraint* nearest = find_nearest_constraint(mouse_pos, constraints);
-        if (nearest) {
-            nearest->deactivate();
-        }
-    }
 };
 
 #endif // INPUT_HANDLER_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "input_log.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+uint32_t float_bits(float f)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+float bits_float(uint32_t bits)
+{
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+}
+
+void InputLog::clear()
+{
+    events.clear();
+    cursor = 0;
+    frames = 0;
+    hash = 0;
+}
+
+void InputLog::finish(uint64_t frames_, uint64_t hash_)
+{
+    frames = frames_;
+    hash = hash_;
+}
+
+bool InputLog::save(const std::string& filename) const
+{
+    std::ofstream ofs(filename);
+    if (!ofs)
+        return false;
+    ofs << "# frames hash\n"
+        << frames << " " << std::hex << hash << std::dec << "\n";
+    ofs << "# frame type index x y z value (浮点数为十六进制位模式)\n";
+    for (const auto& e : events) {
+        ofs << e.frame << " " << static_cast<int>(e.type) << " " << e.index << std::hex
+            << " " << float_bits(e.position.x) << " " << float_bits(e.position.y) << " " << float_bits(e.position.z)
+            << " " << float_bits(e.value) << std::dec << "\n";
+    }
+    return static_cast<bool>(ofs);
+}
+
+bool InputLog::load(const std::string& filename)
+{
+    std::ifstream ifs(filename);
+    if (!ifs)
+        return false;
+    clear();
+    std::string line;
+    bool header = false;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream iss(line);
+        if (!header) {
+            if (!(iss >> frames >> std::hex >> hash))
+                return false;
+            header = true;
+            continue;
+        }
+        InputEvent e;
+        int type;
+        uint32_t x, y, z, value;
+        if (!(iss >> e.frame >> type >> e.index >> std::hex >> x >> y >> z >> value))
+            return false;
+        e.type = static_cast<InputEventType>(type);
+        e.position = Vector3f(bits_float(x), bits_float(y), bits_float(z));
+        e.value = bits_float(value);
+        events.push_back(e);
+    }
+    return header;
+}
+
+std::span<const InputEvent> InputLog::take(uint64_t frame)
+{
+    while (cursor < events.size() && events[cursor].frame < frame)
+        ++cursor;
+    size_t begin = cursor;
+    while (cursor < events.size() && events[cursor].frame == frame)
+        ++cursor;
+    return std::span<const InputEvent>(events.data() + begin, cursor - begin);
+}
+
+uint64_t hash_positions(uint64_t seed, std::span<const Particle> particles)
+{
+    uint64_t h = seed;
+    for (const auto& p : particles) {
+        for (float f : { p.position.x, p.position.y, p.position.z }) {
+            uint32_t bits = float_bits(f);
+            for (int b = 0; b < 4; ++b) {
+                h ^= (bits >> (8 * b)) & 0xffu;
+                h *= 1099511628211ull;
+            }
+        }
+    }
+    return h;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "particle.h"
+#include "vector3f.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// 会影响模拟结果的输入事件，也是交互编辑命令的格式（经 CommandQueue 在步边界执行）；
+// 相机、显示开关等不记录
+enum class InputEventType {
+    Reset, // 按 value 指定的网格类型重置布料
+    DragMove, // 把粒子 index 拖到 position
+    Pin, // 切换粒子 index 的固定状态
+    Tear, // 删除与粒子 index 相关的所有约束
+    Cut, // 停用下标为 index 的约束
+    Gravity, // value 为新的重力
+    Wind, // index 为开关，value 为风力
+    Iterations, // value 为迭代次数上限
+    Chebyshev, // value 非 0 表示开启
+    Multigrid, // value 非 0 表示开启
+    Integrator, // value 为积分方式
+    AutoTear, // value 为自动撕裂的应变阈值，0 表示关闭
+    Load // 从 cloth_save.txt 加载布料（录制、回放期间不可用）
+};
+
+struct InputEvent {
+    uint64_t frame = 0;
+    InputEventType type = InputEventType::Reset;
+    int index = -1;
+    Vector3f position {};
+    float value = 0.0f;
+};
+
+// 带帧号的输入日志：录制时按发生顺序追加，回放时逐帧取出。
+// 浮点数按位模式保存，回放得到的输入与录制时逐位相同。
+class InputLog {
+public:
+    void clear();
+    void record(const InputEvent& event) { events.push_back(event); }
+
+    // 录制结束时记下总帧数和轨迹指纹，回放结束后用来比对
+    void finish(uint64_t frames, uint64_t hash);
+    uint64_t get_frames() const { return frames; }
+    uint64_t get_hash() const { return hash; }
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    // 回放：返回第 frame 帧的全部事件，帧号须递增调用
+    std::span<const InputEvent> take(uint64_t frame);
+    void rewind() { cursor = 0; }
+    size_t size() const { return events.size(); }
+
+private:
+    std::vector<InputEvent> events;
+    size_t cursor = 0;
+    uint64_t frames = 0;
+    uint64_t hash = 0;
+};
+
+// 轨迹指纹：把所有粒子位置的位模式以 FNV-1a 累积到 seed 上
+uint64_t hash_positions(uint64_t seed, std::span<const Particle> particles);
+const uint64_t TRAJECTORY_HASH_SEED = 14695981039346656037ull;
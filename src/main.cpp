@@ -4,14 +4,30 @@
 #include <cmath>
 #include <cstdint>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <vector>
 
 #include "cloth_state.h"
+#include "command_queue.h"
 #include "constants.h"
 #include "constraint.h"
+#include "frustum.h"
+#include "grid_topology.h"
+#include "hud.h"
+#include "implicit_integrator.h"
 #include "input_handler.h"
+#include "input_log.h"
+#include "parallel.h"
 #include "particle.h"
+#include "projective_dynamics.h"
+#include "render_lod.h"
+#include "render_snapshot.h"
+#include "scene.h"
+#include "solver.h"
+#include "strain_color.h"
+#include "surface_mesh.h"
+#include "tearing.h"
+#include "task_scheduler.h"
 #include "vector3f.h"
 
 // 相机参数
@@ -22,10 +38,7 @@ float cam_distance = 800.0f; // 相机距离原点的距离
 const float PITCH_LIMIT = M_PI / 2.0f - 0.01f; // 限制俯仰角防止万向节死锁/翻转
 const float fov_factor = 600.0f; // 视野/焦距因子 for projection
 
-// 网格类型枚举
-enum class GridType { Square,
-    Triangle,
-    Hexagon };
+// 网格类型（枚举定义见 grid_topology.h）
 GridType grid_type = GridType::Square; // 默认正方形
 
 // 函数：根据角度和距离更新相机位置
@@ -66,6 +79,12 @@ Vector3f world_to_camera(const Vector3f& p)
     return Vector3f(cam_x, cam_y, -cam_z);
 }
 
+// 当前相机的视锥，坐标变换与 world_to_camera、project 一致
+ViewFrustum current_frustum(float current_width, float current_height)
+{
+    return ViewFrustum::look_at(cam_pos, Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 1.0f, 0.0f), fov_factor, current_width, current_height);
+}
+
 // 投影：相机坐标 -> 二维屏幕坐标 (简单透视)
 sf::Vector2f project(const Vector3f& world_pos, float current_width, float current_height)
 {
@@ -75,7 +94,7 @@ sf::Vector2f project(const Vector3f& world_pos, float current_width, float curre
     float perspective_z = cam_coords.z; // Z 值代表深度（相机坐标系下，正值在相机前方）
 
     // 防止除以零或负数 (点在相机后方)
-    if (perspective_z <= 0.1f) {
+    if (perspective_z <= CAMERA_NEAR) {
         // perspective_z = 0.1f; // Clamp near plane
         // 或者直接将点移出屏幕
         return sf::Vector2f(-10000, -10000);
@@ -88,101 +107,17 @@ sf::Vector2f project(const Vector3f& world_pos, float current_width, float curre
     return sf::Vector2f(screen_x, screen_y);
 }
 
-void reset_cloth(std::vector<Particle>& particles, std::vector<Constraint>& constraints)
+void reset_cloth(std::vector<Particle>& particles, std::vector<Constraint>& constraints, std::vector<DihedralConstraint>& dihedrals, ConstraintSolver& solver)
 {
-    particles.clear();
-    constraints.clear();
-    int rows_to_use = DEFAULT_ROW;
-    int cols_to_use = DEFAULT_COL;
-    float rest_distance_to_use = DEFAULT_REST_DISTANCE;
-
-    if (grid_type == GridType::Square) {
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * rest_distance_to_use - WIDTH / 6;
-                float y = row * rest_distance_to_use + HEIGHT / 6;
-                float z = (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f + 100.0f; // 简单z扰动
-                bool pinned = (row == 0);
-                particles.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                if (col < cols_to_use - 1) {
-                    constraints.emplace_back(&particles[row * cols_to_use + col], &particles[row * cols_to_use + col + 1], rest_distance_to_use);
-                }
-                if (row < rows_to_use - 1) {
-                    constraints.emplace_back(&particles[row * cols_to_use + col], &particles[(row + 1) * cols_to_use + col], rest_distance_to_use);
-                }
-            }
-        }
-    } else if (grid_type == GridType::Triangle) {
-        // 三角形网格：每个点与右、下、右下、左下相连
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * rest_distance_to_use - WIDTH / 6;
-                float y = row * rest_distance_to_use + HEIGHT / 6;
-                float z = (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f + 100.0f;
-                bool pinned = (row == 0);
-                particles.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                int idx = row * cols_to_use + col;
-                if (col < cols_to_use - 1) // 右
-                    constraints.emplace_back(&particles[idx], &particles[idx + 1], rest_distance_to_use);
-                if (row < rows_to_use - 1) // 下
-                    constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use], rest_distance_to_use);
-                if (col < cols_to_use - 1 && row < rows_to_use - 1) // 右下
-                    constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use + 1], rest_distance_to_use * std::sqrt(2.f)); // Diagonal
-                if (col > 0 && row < rows_to_use - 1) // 左下
-                    constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use - 1], rest_distance_to_use * std::sqrt(2.f)); // Diagonal
-            }
-        }
-    } else if (grid_type == GridType::Hexagon) {
-        // 六边形网格：蜂窝状排列
-        float hex_dx = rest_distance_to_use * 0.866f; // cos(30°)
-        float hex_dy = rest_distance_to_use * 0.75f; // 行间距
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * hex_dx + (row % 2) * (hex_dx / 2) + WIDTH / 6;
-                float y = row * hex_dy + HEIGHT / 6;
-                float z = (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f + 100.0f;
-                bool pinned = (row == 0);
-                particles.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                int idx = row * cols_to_use + col;
-                // 水平方向连接 (右)
-                if (col < cols_to_use - 1)
-                    constraints.emplace_back(&particles[idx], &particles[idx + 1], hex_dx);
-
-                // 斜向下连接 (考虑奇偶行)
-                if (row < rows_to_use - 1) {
-                    // 奇数行: 左下和右下
-                    if (row % 2 == 1) {
-                        if (col > 0)
-                            constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use - 1], rest_distance_to_use); // 左下
-                        constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use], rest_distance_to_use); // 正下 (近似)
-                    }
-                    // 偶数行: 左下和右下
-                    else {
-                        constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use], rest_distance_to_use); // 正下 (近似)
-                        if (col < cols_to_use - 1)
-                            constraints.emplace_back(&particles[idx], &particles[idx + cols_to_use + 1], rest_distance_to_use); // 右下
-                    }
-                }
-            }
-        }
-    }
-    for (auto& c : constraints) {
-        if (c.initial_length <= 0) {
-            // Temporary fix: use default rest distance if calculation isn't straightforward here
-        }
-    }
+    // 顶行固定，沿对角线加一点 z 扰动；拓扑由 build_grid 缓存，重复重置只复制数组
+    GridPlacement placement;
+    placement.origin = Vector3f(-WIDTH / 6, HEIGHT / 6, 100.0f);
+    placement.depth_ramp = 200.0f;
+    placement.pin_top_row = true;
+    build_grid(grid_type, DEFAULT_ROW, DEFAULT_COL, DEFAULT_REST_DISTANCE, placement, particles, constraints, dihedrals);
+    // 粒子按行优先排列，供多重网格建立粗层
+    solver.set_grid(DEFAULT_ROW, DEFAULT_COL, grid_type);
+    solver.invalidate_tethers();
 }
 
 int main()
@@ -195,6 +130,7 @@ int main()
 
     std::vector<Particle> particles;
     std::vector<Constraint> constraints;
+    std::vector<DihedralConstraint> dihedrals; // 二面角弯曲约束
 
     // 拖拽相关变量
     bool dragging = false;
@@ -212,10 +148,202 @@ int main()
     float gravity = GRAVITY_CONST;
 
     bool tear_mode = false;
+    float auto_tear_strain = 0.0f; // 自动撕裂阈值，0 为关闭（K 键切换）
+    Tearing tearing;
+    size_t auto_torn = 0; // 自动断开的约束累计数
 
     bool display_info_message = false; // 用于控制左下角信息显示
+    bool surface_mode = false; // 着色三角网格显示
+
+    ConstraintSolver solver; // 约束求解器（自适应迭代次数）
+    Integrator integrator = Integrator::Verlet;
+    ImplicitIntegrator implicit_integrator;
+    ProjectiveDynamics projective_dynamics;
+    Scene scene; // 多布料场景（G 键切换）
+    bool scene_mode = false;
+    bool imported_mesh = false; // Ctrl+L 加载的网格不是规则网格，渲染时不做 LOD
+
+    // 确定性录制/回放（F5 录制，F6 回放 input_log.txt）
+    InputLog input_log;
+    bool recording = false;
+    bool replaying = false;
+    uint64_t frame = 0; // 录制/回放开始后的物理帧数
+    uint64_t trajectory_hash = TRAJECTORY_HASH_SEED;
+
+    bool mesh_replaced = false; // 本轮步边界上加载了新网格
+    // 执行一个会改变模拟的输入事件；实时输入和回放都经由这里
+    auto apply_event = [&](const InputEvent& e) {
+        const bool valid_particle = e.index >= 0 && e.index < static_cast<int>(particles.size());
+        switch (e.type) {
+        case InputEventType::Reset:
+            grid_type = static_cast<GridType>(static_cast<int>(e.value));
+            reset_cloth(particles, constraints, dihedrals, solver);
+            implicit_integrator.invalidate();
+            projective_dynamics.invalidate();
+            tearing.invalidate();
+            auto_torn = 0;
+            imported_mesh = false;
+            dragging = false;
+            dragged_particle = nullptr;
+            break;
+        case InputEventType::DragMove:
+            if (valid_particle) {
+                particles[e.index].position = e.position;
+                // Since we moved the particle, also update previous_position to avoid velocity jump
+                particles[e.index].previous_position = e.position;
+            }
+            break;
+        case InputEventType::Pin:
+            if (valid_particle) {
+                particles[e.index].is_pinned = !particles[e.index].is_pinned;
+                solver.invalidate_tethers(); // 固定点变化，重建长程附着约束
+            }
+            break;
+        case InputEventType::Tear:
+            if (valid_particle) {
+                // 删除与该粒子相关的所有约束
+                Particle* torn = &particles[e.index];
+                constraints.erase(
+                    std::remove_if(constraints.begin(), constraints.end(),
+                        [torn](const Constraint& c) {
+                            return c.p1 == torn || c.p2 == torn;
+                        }),
+                    constraints.end());
+                dihedrals.erase(
+                    std::remove_if(dihedrals.begin(), dihedrals.end(),
+                        [torn](const DihedralConstraint& d) { return d.uses(torn); }),
+                    dihedrals.end());
+                implicit_integrator.invalidate();
+                projective_dynamics.invalidate();
+                tearing.invalidate();
+            }
+            break;
+        case InputEventType::Cut:
+            if (e.index >= 0 && e.index < static_cast<int>(constraints.size())) {
+                constraints[e.index].deactivate();
+                implicit_integrator.invalidate();
+                projective_dynamics.invalidate();
+            }
+            break;
+        case InputEventType::Gravity:
+            gravity = e.value;
+            break;
+        case InputEventType::Wind:
+            wind_on = e.index != 0;
+            wind_strength = e.value;
+            break;
+        case InputEventType::Iterations:
+            solver.settings.max_iterations = static_cast<int>(e.value);
+            break;
+        case InputEventType::Chebyshev:
+            solver.settings.acceleration = e.value != 0 ? SolverAcceleration::Chebyshev : SolverAcceleration::None;
+            break;
+        case InputEventType::Multigrid:
+            solver.settings.multigrid = e.value != 0;
+            break;
+        case InputEventType::Integrator:
+            integrator = static_cast<Integrator>(static_cast<int>(e.value));
+            break;
+        case InputEventType::AutoTear:
+            auto_tear_strain = e.value;
+            break;
+        case InputEventType::Load:
+            TaskScheduler::instance().wait_idle(); // 等待尚未写完的存档
+            if (ClothState::load(particles, constraints, "cloth_save.txt")) {
+                dihedrals.clear();
+                solver.set_grid(0, 0); // 导入的网格不是规则网格
+                solver.invalidate_tethers();
+                implicit_integrator.invalidate();
+                projective_dynamics = ProjectiveDynamics();
+                tearing.invalidate();
+                auto_torn = 0;
+                imported_mesh = true;
+                // 粒子数组已替换：拖拽指针失效，排在后面的编辑按旧网格的下标生成
+                dragging = false;
+                dragged_particle = nullptr;
+                mesh_replaced = true;
+                std::cout << "布料已从 cloth_save.txt 加载" << std::endl;
+            } else
+                std::cout << "加载失败！" << std::endl;
+            break;
+        }
+    };
+    // 实时输入作为编辑命令进入无锁队列，在步边界（物理步不在运行时）统一执行；回放期间忽略
+    CommandQueue<InputEvent> edits;
+    auto submit = [&](InputEvent e) {
+        if (replaying)
+            return;
+        e.frame = frame;
+        if (!edits.push(e))
+            std::cerr << "编辑命令队列已满，丢弃一条命令" << std::endl;
+    };
+    // 执行排队的编辑命令，录制时写入日志
+    auto apply_pending = [&]() {
+        mesh_replaced = false;
+        edits.drain([&](const InputEvent& e) {
+            if (mesh_replaced)
+                return; // 加载之后的编辑指向旧网格，丢弃
+            apply_event(e);
+            if (recording)
+                input_log.record(e);
+        });
+    };
+    // 录制/回放开始：固定并行分块，清空求解器的缓存，帧号和指纹归零
+    auto start_session = [&]() {
+        set_parallel_deterministic(true);
+        solver = ConstraintSolver();
+        implicit_integrator = ImplicitIntegrator();
+        projective_dynamics = ProjectiveDynamics();
+        dragging = false;
+        dragged_particle = nullptr;
+        frame = 0;
+        trajectory_hash = TRAJECTORY_HASH_SEED;
+    };
+
+    // 一个物理步，在后台任务中运行
+    SolverStats step_stats;
+    std::vector<float> strain; // Gauss-Seidel 求解器顺带写出的约束应变，供线框着色
+    bool strain_solved = false; // 上一步是否写了 strain（投影动力学不经过该求解器）
+    auto step_physics = [&]() {
+        if (scene_mode) {
+            // 场景沿用当前的求解参数，按布料实例并行推进
+            scene.settings = solver.settings;
+            scene.step(gravity, wind_on ? wind_strength : 0.0f, TIME_STEP);
+            step_stats = scene.get_last_stats();
+            return;
+        }
+        // apply gravity and update particles
+        for (auto& particle : particles) {
+            particle.apply_force(Vector3f(0, -gravity, 0));
+            if (wind_on) {
+                particle.apply_force(Vector3f(wind_strength, 0, 0));
+            }
+            if (integrator == Integrator::Verlet)
+                particle.update(TIME_STEP);
+            particle.constrain_to_bounds(WIDTH, HEIGHT, 1000.0f);
+        }
+        if (integrator == Integrator::ImplicitEuler) {
+            implicit_integrator.step(particles, constraints, TIME_STEP);
+        }
 
-    reset_cloth(particles, constraints);
+        // 约束迭代，误差低于阈值时提前结束；投影动力学模式下积分与约束求解一并完成
+        strain_solved = integrator != Integrator::ProjectiveDynamics;
+        strain.resize(strain_solved ? constraints.size() : 0);
+        step_stats = strain_solved
+            ? solver.solve(particles, constraints, dihedrals, strain)
+            : projective_dynamics.step(particles, constraints, TIME_STEP, solver.settings);
+        // 自动撕裂：这里只并行收集超过阈值的约束，断开和分裂粒子在步边界统一执行
+        if (auto_tear_strain > 0.0f && strain_solved)
+            tearing.collect(constraints, strain, auto_tear_strain);
+    };
+
+    reset_cloth(particles, constraints, dihedrals, solver);
+
+    // 流水线：第 N 帧的投影与绘制和第 N+1 帧的物理步同时进行
+    TaskGroup physics_job;
+    bool step_running = false;
+    SolverStats solver_stats; // 最近完成的一步的统计
+    RenderSnapshot snapshot;
 
     sf::Clock fpsClock;
     float lastFrameTime = fpsClock.getElapsedTime().asSeconds();
@@ -226,6 +354,40 @@ int main()
         const float current_win_width = static_cast<float>(window_size.x);
         const float current_win_height = static_cast<float>(window_size.y);
 
+        // 步边界：等待上一轮启动的物理步结束，之后可以安全地读写模拟状态
+        TaskScheduler::instance().wait(physics_job);
+        if (step_running) {
+            step_running = false;
+            solver_stats = step_stats;
+            if (!scene_mode && tearing.has_candidates()) {
+                const ptrdiff_t dragged = dragged_particle ? dragged_particle - particles.data() : -1;
+                TearResult torn = tearing.apply(particles, constraints, dihedrals);
+                if (torn.particles_moved && dragged >= 0)
+                    dragged_particle = particles.data() + dragged;
+                if (torn.broken > 0) {
+                    solver.invalidate_tethers();
+                    implicit_integrator.invalidate();
+                    projective_dynamics.invalidate();
+                }
+                auto_torn += torn.broken;
+            }
+            // 录制/回放：逐帧累积轨迹指纹，回放到录制的帧数时比对
+            if (!scene_mode && (recording || replaying)) {
+                trajectory_hash = hash_positions(trajectory_hash, particles);
+                ++frame;
+                if (replaying && frame >= input_log.get_frames()) {
+                    replaying = false;
+                    set_parallel_deterministic(false);
+                    std::cout << "回放结束：" << (trajectory_hash == input_log.get_hash() ? "轨迹逐位一致" : "轨迹不一致！") << std::endl;
+                }
+            }
+        }
+        // 本轮绘制的数据
+        if (scene_mode)
+            snapshot.capture(scene.get_particles(), scene.get_constraints(), scene.get_strain());
+        else
+            snapshot.capture(particles, constraints, strain_solved ? std::span<const float>(strain) : std::span<const float>());
+
         while (auto event = window.pollEvent()) {
             if (event->is<sf::Event::Closed>()) {
                 window.close();
@@ -246,7 +408,7 @@ int main()
             // 鼠标按下，查找最近粒子
             if (event->is<sf::Event::MouseButtonPressed>()) {
                 auto mouse = event->getIf<sf::Event::MouseButtonPressed>();
-                if (mouse && mouse->button == sf::Mouse::Button::Left) {
+                if (mouse && mouse->button == sf::Mouse::Button::Left && !scene_mode) {
                     sf::Vector2i mousePos = mouse->position; // Use raw pixel coords
                     float minDistSq = 1e18f; // Use squared distance
                     const float thresholdSq = 30.0f * 30.0f; // Squared threshold (30 pixels)
@@ -267,13 +429,7 @@ int main()
                         }
                     }
                     if (tear_mode && nearest) {
-                        // 删除与该粒子相关的所有约束
-                        constraints.erase(
-                            std::remove_if(constraints.begin(), constraints.end(),
-                                [nearest](const Constraint& c) {
-                                    return c.p1 == nearest || c.p2 == nearest;
-                                }),
-                            constraints.end());
+                        submit({ .type = InputEventType::Tear, .index = static_cast<int>(nearest - particles.data()) });
                     } else {
                         if (nearest && !nearest->is_pinned) {
                             dragging = true;
@@ -296,7 +452,7 @@ int main()
             // 鼠标右键切换粒子固定状态
             if (event->is<sf::Event::MouseButtonPressed>()) {
                 auto mouse = event->getIf<sf::Event::MouseButtonPressed>();
-                if (mouse && mouse->button == sf::Mouse::Button::Right) {
+                if (mouse && mouse->button == sf::Mouse::Button::Right && !scene_mode) {
                     sf::Vector2i mousePos = mouse->position; // Use raw pixel coords
                     float minDistSq = 1e18f; // Use squared distance
                     const float thresholdSq = 30.0f * 30.0f; // Squared threshold (30 pixels)
@@ -317,7 +473,7 @@ int main()
                         }
                     }
                     if (nearest) {
-                        nearest->is_pinned = !nearest->is_pinned;
+                        submit({ .type = InputEventType::Pin, .index = static_cast<int>(nearest - particles.data()) });
                     }
                 }
             }
@@ -346,26 +502,25 @@ int main()
                     bool camera_updated = false; // 标记相机角度/距离是否变化
                     // 空格键控制风力
                     if (key->code == sf::Keyboard::Key::Space) {
-                        wind_on = !wind_on;
-                        wind_strength = wind_on ? 100.0f : 0.0f;
+                        submit({ .type = InputEventType::Wind, .index = !wind_on, .value = !wind_on ? 100.0f : 0.0f });
                     }
                     // R键重置布料
                     if (key->code == sf::Keyboard::Key::R) {
-                        reset_cloth(particles, constraints);
+                        submit({ .type = InputEventType::Reset, .value = static_cast<float>(grid_type) });
                     }
                     // +/-键调整重力
                     if (key->code == sf::Keyboard::Key::Equal) {
-                        gravity += 1.0f;
+                        submit({ .type = InputEventType::Gravity, .value = gravity + 1.0f });
                     }
                     if (key->code == sf::Keyboard::Key::Hyphen) {
-                        gravity -= 1.0f;
+                        submit({ .type = InputEventType::Gravity, .value = gravity - 1.0f });
                     }
                     // [ / ]键调整风力
                     if (key->code == sf::Keyboard::Key::LBracket) {
-                        wind_strength -= 10.0f;
+                        submit({ .type = InputEventType::Wind, .index = wind_on, .value = wind_strength - 10.0f });
                     }
                     if (key->code == sf::Keyboard::Key::RBracket) {
-                        wind_strength += 10.0f;
+                        submit({ .type = InputEventType::Wind, .index = wind_on, .value = wind_strength + 10.0f });
                     }
                     // 相机旋转控制 (轨道模式)
                     if (key->code == sf::Keyboard::Key::A) {
@@ -391,18 +546,90 @@ int main()
                     }
                     // T键切换三角形网格
                     if (key->code == sf::Keyboard::Key::T) {
-                        grid_type = GridType::Triangle;
-                        reset_cloth(particles, constraints);
+                        submit({ .type = InputEventType::Reset, .value = static_cast<float>(GridType::Triangle) });
                     }
                     // H键切换六边形网格
                     if (key->code == sf::Keyboard::Key::H) {
-                        grid_type = GridType::Hexagon;
-                        reset_cloth(particles, constraints);
+                        submit({ .type = InputEventType::Reset, .value = static_cast<float>(GridType::Hexagon) });
                     }
                     // Q键切换正方形网格
                     if (key->code == sf::Keyboard::Key::Q) {
-                        grid_type = GridType::Square;
-                        reset_cloth(particles, constraints);
+                        submit({ .type = InputEventType::Reset, .value = static_cast<float>(GridType::Square) });
+                    }
+                    // , / . 键调整约束迭代次数上限
+                    if (key->code == sf::Keyboard::Key::Comma && solver.settings.max_iterations > 1) {
+                        submit({ .type = InputEventType::Iterations, .value = static_cast<float>(solver.settings.max_iterations - 1) });
+                    }
+                    if (key->code == sf::Keyboard::Key::Period) {
+                        submit({ .type = InputEventType::Iterations, .value = static_cast<float>(solver.settings.max_iterations + 1) });
+                    }
+                    // C键切换 Chebyshev 加速
+                    if (key->code == sf::Keyboard::Key::C) {
+                        bool on = solver.settings.acceleration != SolverAcceleration::Chebyshev;
+                        submit({ .type = InputEventType::Chebyshev, .value = on ? 1.0f : 0.0f });
+                    }
+                    // M键切换多重网格求解
+                    if (key->code == sf::Keyboard::Key::M) {
+                        submit({ .type = InputEventType::Multigrid, .value = solver.settings.multigrid ? 0.0f : 1.0f });
+                    }
+                    // K键切换按应变自动撕裂
+                    if (key->code == sf::Keyboard::Key::K) {
+                        submit({ .type = InputEventType::AutoTear, .value = auto_tear_strain > 0.0f ? 0.0f : AUTO_TEAR_STRAIN });
+                    }
+                    // E键切换积分方式：显式 Verlet / 隐式欧拉 / 投影动力学
+                    if (key->code == sf::Keyboard::Key::E) {
+                        submit({ .type = InputEventType::Integrator, .value = static_cast<float>(next_integrator(integrator)) });
+                    }
+                    // F5 开始/结束录制：当前参数作为第 0 帧的事件写入日志，回放从同样的状态开始
+                    if (key->code == sf::Keyboard::Key::F5 && !scene_mode && !replaying) {
+                        if (!recording) {
+                            SolverSettings settings = solver.settings;
+                            Integrator current_integrator = integrator;
+                            start_session();
+                            input_log.clear();
+                            recording = true;
+                            submit({ .type = InputEventType::Reset, .value = static_cast<float>(grid_type) });
+                            submit({ .type = InputEventType::Gravity, .value = gravity });
+                            submit({ .type = InputEventType::Wind, .index = wind_on, .value = wind_strength });
+                            submit({ .type = InputEventType::Iterations, .value = static_cast<float>(settings.max_iterations) });
+                            submit({ .type = InputEventType::Chebyshev, .value = settings.acceleration == SolverAcceleration::Chebyshev ? 1.0f : 0.0f });
+                            submit({ .type = InputEventType::Multigrid, .value = settings.multigrid ? 1.0f : 0.0f });
+                            submit({ .type = InputEventType::Integrator, .value = static_cast<float>(current_integrator) });
+                            submit({ .type = InputEventType::AutoTear, .value = auto_tear_strain });
+                        } else {
+                            recording = false;
+                            set_parallel_deterministic(false);
+                            input_log.finish(frame, trajectory_hash);
+                            // 写文件交给后台任务，不阻塞渲染
+                            TaskScheduler::instance().async([log = input_log] {
+                                if (log.save("input_log.txt"))
+                                    std::cout << "已录制 " << log.get_frames() << " 帧到 input_log.txt" << std::endl;
+                                else
+                                    std::cout << "保存输入日志失败！" << std::endl;
+                            });
+                        }
+                    }
+                    // F6 回放 input_log.txt
+                    if (key->code == sf::Keyboard::Key::F6 && !scene_mode && !recording && !replaying) {
+                        TaskScheduler::instance().wait_idle(); // 等待尚未写完的录制文件
+                        if (input_log.load("input_log.txt")) {
+                            start_session();
+                            replaying = true;
+                        } else {
+                            std::cout << "读取 input_log.txt 失败！" << std::endl;
+                        }
+                    }
+                    // G键切换体育场场景：多面旗帜、窗帘和丝袜共用一组数组并行求解
+                    if (key->code == sf::Keyboard::Key::G && !recording && !replaying) {
+                        scene_mode = !scene_mode;
+                        if (scene_mode)
+                            scene.build_stadium(STADIUM_FLAGS);
+                        else
+                            scene.clear();
+                    }
+                    // V键切换着色表面 / 点线显示
+                    if (key->code == sf::Keyboard::Key::V) {
+                        surface_mode = !surface_mode;
                     }
                     // I键切换信息显示
                     if (key->code == sf::Keyboard::Key::I) {
@@ -410,18 +637,23 @@ int main()
                     }
                     // 保存/加载布料状态
                     if (key->code == sf::Keyboard::Key::S && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) {
-                        if (ClothState::save(particles, constraints, "cloth_save.txt"))
-                            std::cout << "布料已保存到 cloth_save.txt" << std::endl;
-                        else
-                            std::cout << "保存失败！" << std::endl;
-                    }
-                    // Ctrl+L 加载
-                    if (key->code == sf::Keyboard::Key::L && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) {
-                        if (ClothState::load(particles, constraints, "cloth_save.txt"))
-                            std::cout << "布料已从 cloth_save.txt 加载" << std::endl;
-                        else
-                            std::cout << "加载失败！" << std::endl;
+                        // 后台存盘：先复制粒子和约束，并把约束指针改指向副本
+                        auto saved_particles = std::make_shared<std::vector<Particle>>(particles);
+                        auto saved_constraints = std::make_shared<std::vector<Constraint>>(constraints);
+                        for (auto& c : *saved_constraints) {
+                            c.p1 = saved_particles->data() + (c.p1 - particles.data());
+                            c.p2 = saved_particles->data() + (c.p2 - particles.data());
+                        }
+                        TaskScheduler::instance().async([saved_particles, saved_constraints] {
+                            if (ClothState::save(*saved_particles, *saved_constraints, "cloth_save.txt"))
+                                std::cout << "布料已保存到 cloth_save.txt" << std::endl;
+                            else
+                                std::cout << "保存失败！" << std::endl;
+                        });
                     }
+                    // Ctrl+L 加载：与重置一样作为编辑命令，在步边界替换网格
+                    if (key->code == sf::Keyboard::Key::L && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl) && !recording && !replaying)
+                        submit({ .type = InputEventType::Load });
                 }
             }
             // 鼠标滚轮控制相机前后移动 (调整距离)
@@ -449,8 +681,18 @@ int main()
                     update_camera_position(); // 根据新距离重新计算相机位置
                 }
             }
-            // 其他事件
-            InputHandler::handle_mouse_click(*event, particles, constraints);
+            // 其他事件：左键点中约束时将其断开
+            if (!scene_mode) {
+                int cut = InputHandler::constraint_at(*event, constraints);
+                if (cut >= 0)
+                    submit({ .type = InputEventType::Cut, .index = cut });
+            }
+        }
+
+        // 回放：执行本帧录下的事件
+        if (replaying) {
+            for (const auto& e : input_log.take(frame))
+                apply_event(e);
         }
 
         // 拖拽时让粒子跟随鼠标 (使用反向投影)
@@ -483,26 +725,15 @@ int main()
             Vector3f new_world_pos = cam_pos + xaxis * P_cam.x + yaxis * P_cam.y - zaxis * P_cam.z;
 
             // Update particle position
-            dragged_particle->position = new_world_pos;
-            // Since we moved the particle, also update previous_position to avoid velocity jump
-            dragged_particle->previous_position = new_world_pos;
-        }
-
-        // apply gravity and update particles
-        for (auto& particle : particles) {
-            particle.apply_force(Vector3f(0, -gravity, 0));
-            if (wind_on) {
-                particle.apply_force(Vector3f(wind_strength, 0, 0));
-            }
-            particle.update(TIME_STEP);
-            particle.constrain_to_bounds(WIDTH, HEIGHT, 1000.0f);
+            submit({ .type = InputEventType::DragMove, .index = static_cast<int>(dragged_particle - particles.data()), .position = new_world_pos });
         }
 
-        for (size_t i = 0; i < 5; i++) {
-            for (auto& constraint : constraints) {
-                constraint.satisfy();
-            }
-        }
+        // 步边界上执行排队的编辑，然后在后台启动下一步物理；
+        // 此后直到下一轮 wait 之前，主线程只读渲染快照
+        apply_pending();
+        // 只捕获一个引用，std::function 不分配堆内存；上下文由 physics_job 复用
+        TaskScheduler::instance().async(physics_job, [&step_physics] { step_physics(); });
+        step_running = true;
 
         window.clear(sf::Color::Black);
 
@@ -588,27 +819,96 @@ int main()
         //     window.draw(circle);
         // }
 
-        // Draw particles as points
-        for (const auto& particle : particles) {
-            sf::Color color = particle.is_pinned ? sf::Color::Red : sf::Color(255, 255 - (int)(particle.position.y / HEIGHT * 255), 255 - (int)(particle.position.z / 1000.0f * 255));
-            sf::Vertex point { project(particle.position, current_win_width, current_win_height), color };
-            window.draw(&point, 1, sf::PrimitiveType::Points);
+        // 从快照并行投影粒子并计算视锥外码，只为视锥内的点和线生成顶点，各一次绘制调用。
+        // 布料在屏幕上过密时改画 LOD 粗网格，只投影粗网格上的粒子
+        const std::vector<Vector3f>& shown_positions = snapshot.positions;
+        struct ProjectedPoint {
+            Vector3f camera; // 相机坐标
+            ScreenPoint screen; // 屏幕坐标（只在近平面前方有效）
+            uint8_t outcode; // 视锥外码，0 表示可见
+        };
+        static std::vector<ProjectedPoint> projected;
+        static std::vector<sf::Vertex> point_vertices;
+        static std::vector<sf::Vertex> line_vertices;
+        static std::vector<RenderGrid> render_grids;
+        static RenderLod render_lod;
+        const ViewFrustum frustum = current_frustum(current_win_width, current_win_height);
+        render_grids.clear();
+        if (scene_mode) {
+            for (const auto& inst : scene.get_instances())
+                render_grids.push_back({ inst.first_particle, inst.rows, inst.cols, inst.spacing, GridType::Square, inst.shape == ClothShape::Stocking });
+        } else if (!imported_mesh) {
+            render_grids.push_back({ 0, DEFAULT_ROW, DEFAULT_COL, DEFAULT_REST_DISTANCE, grid_type });
+        }
+        // 表面模式画带光照的三角网格，不再画点和线；没有规则网格（导入的网格）时退回点线显示
+        static SurfaceMesh surface_mesh;
+        static std::vector<ScreenVertex> surface_vertices;
+        static std::vector<sf::Vertex> triangle_vertices;
+        const bool surface = surface_mode && surface_mesh.set_grids(render_grids, shown_positions.size());
+        if (surface) {
+            surface_mesh.build(shown_positions, frustum, surface_vertices);
+            triangle_vertices.resize(surface_vertices.size());
+            parallel_for(surface_vertices.size(), 4096, [&](size_t i) {
+                const ScreenVertex& v = surface_vertices[i];
+                triangle_vertices[i] = { v.position, sf::Color(v.color.r, v.color.g, v.color.b) };
+            });
+            window.draw(triangle_vertices.data(), triangle_vertices.size(), sf::PrimitiveType::Triangles);
+        }
+        const bool lod = !surface && render_lod.update(shown_positions, render_grids, frustum);
+        const std::span<const uint32_t> lod_points = render_lod.points();
+        std::span<const RenderSnapshot::Line> shown_lines;
+        size_t shown_point_count = 0;
+        if (!surface) {
+            shown_lines = lod ? render_lod.lines() : std::span<const RenderSnapshot::Line>(snapshot.lines);
+            shown_point_count = lod ? lod_points.size() : shown_positions.size();
         }
+        auto point_index = [&](size_t k) -> size_t { return lod ? lod_points[k] : k; };
+
+        projected.resize(shown_positions.size());
+        parallel_for(shown_point_count, 1024, [&](size_t k) {
+            const size_t i = point_index(k);
+            ProjectedPoint& p = projected[i];
+            p.camera = frustum.to_camera(shown_positions[i]);
+            p.outcode = frustum.outcode(p.camera);
+            if (!(p.outcode & ViewFrustum::Near))
+                p.screen = frustum.to_screen(p.camera);
+        });
+        parallel_compact(shown_point_count, 1024, 1, point_vertices, [&](size_t k, sf::Vertex* out) -> size_t {
+            const size_t i = point_index(k);
+            if (projected[i].outcode)
+                return 0;
+            const Vector3f& pos = shown_positions[i];
+            sf::Color color = snapshot.pinned[i] ? sf::Color::Red : sf::Color(255, 255 - (int)(pos.y / HEIGHT * 255), 255 - (int)(pos.z / 1000.0f * 255));
+            *out = { projected[i].screen, color };
+            return 1;
+        });
+        // 两端在同一视锥平面之外的线整段跳过，穿过近平面的线先裁剪再投影
+        parallel_compact(shown_lines.size(), 1024, 2, line_vertices, [&](size_t k, sf::Vertex* out) -> size_t {
+            const RenderSnapshot::Line& l = shown_lines[k];
+            const ProjectedPoint& a = projected[l.a];
+            const ProjectedPoint& b = projected[l.b];
+            ScreenPoint screen_a = a.screen, screen_b = b.screen;
+            if ((a.outcode | b.outcode) && !frustum.clip_segment(a.camera, a.outcode, b.camera, b.outcode, screen_a, screen_b))
+                return 0;
+            // 细约束直接用求解器最后一轮测得的应变；粗线跨过的细约束可能已经撕开，拉得过长的粗线不画
+            float strain = l.strain;
+            if (lod) {
+                float len = (shown_positions[l.a] - shown_positions[l.b]).length();
+                if (len > RENDER_BREAK_STRETCH * l.rest_length)
+                    return 0;
+                strain = std::abs(len - l.rest_length) / l.rest_length;
+            }
+            const Rgb rgb = strain_color(strain);
+            sf::Color lineColor(rgb.r, rgb.g, rgb.b);
+            out[0] = { screen_a, lineColor };
+            out[1] = { screen_b, lineColor };
+            return 2;
+        });
 
+        // Draw particles as points
+        window.draw(point_vertices.data(), point_vertices.size(), sf::PrimitiveType::Points);
         // Draw constraints as lines
-        for (const auto& constraint : constraints) {
-            if (!constraint.active) {
-                continue;
-            }
-            float len = (constraint.p1->position - constraint.p2->position).length();
-            float t = std::min(std::abs(len - constraint.initial_length) / (constraint.initial_length * 0.5f), 1.0f);
-            sf::Color lineColor = sf::Color(255, (uint8_t)(255 * (1 - t)), (uint8_t)(255 * (1 - t)));
-            sf::Vertex line[] = {
-                { project(constraint.p1->position, current_win_width, current_win_height), lineColor },
-                { project(constraint.p2->position, current_win_width, current_win_height), lineColor },
-            };
-            window.draw(line, 2, sf::PrimitiveType::Lines);
-        }
+        window.draw(line_vertices.data(), line_vertices.size(), sf::PrimitiveType::Lines);
 
         // 绘制左上角相机参考系
         static sf::Font font;
@@ -640,42 +940,86 @@ int main()
             fps = alpha * (1.0f / deltaTime) + (1 - alpha) * fps;
         }
         if (font_loaded) {
-            std::stringstream ss;
-            ss << "Points: " << particles.size() << "\nConstraints: " << constraints.size() << "\nFPS: " << fps << "\nTear Mode: " << (tear_mode ? "ON" : "OFF") << "\nWind Mode: " << (wind_on ? "ON" : "OFF");
-            ss << "\nGrid: ";
-            if (grid_type == GridType::Square)
-                ss << "Square";
-            else if (grid_type == GridType::Triangle)
-                ss << "Triangle";
-            else if (grid_type == GridType::Hexagon)
-                ss << "Hexagon";
-            sf::Text info(font, ss.str());
-            info.setFillColor(sf::Color::White);
-            info.setPosition(sf::Vector2f(static_cast<float>(current_win_width - 350), 20.f)); // 右上角
-            window.draw(info);
-            // 绘制操作说明（右下角，英文）
-            std::string help_str = "Left click: Drag particle\n"
-                                   "Right click: Pin/unpin\n"
-                                   "Middle click: Pan\n"
-                                   "Mouse wheel: Zoom\n"
-                                   "R: Reset cloth\n"
-                                   "+/-: Gravity\n"
-                                   "[ ]: Wind\n"
-                                   "WASD: Rotate view\n"
-                                   "Space: Toggle wind\n"
-                                   "T: Triangle grid\n"
-                                   "H: Hex grid\n"
-                                   "Q: Square grid\n"
-                                   "Ctrl+S: Save cloth\n"
-                                   "Ctrl+L: Load cloth";
-            sf::Text help(font, help_str);
-            help.setFillColor(sf::Color(200, 200, 200));
-            help.setCharacterSize(22);
-            auto helpBounds = help.getLocalBounds();
-            float helpWidth = helpBounds.size.x;
-            float helpHeight = helpBounds.size.y;
-            help.setPosition(sf::Vector2f(current_win_width - helpWidth - 40.f, current_win_height - helpHeight - 80.f));
-            window.draw(help);
+            // HUD 面板在字体加载后创建一次，之后逐行更新，内容不变的行不会重排字形
+            static HudPanel stats_hud(font, 30, sf::Color::White);
+            static HudPanel help_hud(font, 22, sf::Color(200, 200, 200));
+            static HudPanel info_hud(font, 18, sf::Color::Yellow);
+            static HudRefresh hud_refresh;
+            static HudLine line;
+
+            // 开关类字段每帧检查，数值类字段按 HUD_REFRESH_HZ 节流；行数变化时立即全部刷新
+            const size_t batch_row = 12;
+            const size_t stats_rows = batch_row + CONSTRAINT_TYPE_COUNT + (scene_mode ? 1 : 0) + (recording || replaying ? 1 : 0);
+            const bool refresh = hud_refresh.due() || stats_hud.line_count() != stats_rows;
+            stats_hud.set_line_count(stats_rows);
+            stats_hud.set_line(0, line.clear() << "Points: " << shown_positions.size());
+            stats_hud.set_line(1, line.clear() << "Constraints: " << snapshot.constraint_count);
+            stats_hud.set_line(5, line.clear() << "Chebyshev: " << (solver.settings.acceleration == SolverAcceleration::Chebyshev ? "ON" : "OFF"));
+            stats_hud.set_line(8, line.clear() << "Integrator: " << integrator_name(integrator));
+            line.clear() << "Tear Mode: " << (tear_mode ? "ON" : "OFF") << ", Auto: ";
+            if (auto_tear_strain > 0.0f)
+                line << ">" << HudFixed { auto_tear_strain * 100.0f, 0 } << "%, " << auto_torn << " broken";
+            else
+                line << "OFF";
+            stats_hud.set_line(9, line);
+            stats_hud.set_line(10, line.clear() << "Wind Mode: " << (wind_on ? "ON" : "OFF"));
+            stats_hud.set_line(11, line.clear() << "Grid: " << grid_type_name(grid_type));
+            if (refresh) {
+                stats_hud.set_line(2, line.clear() << "FPS: " << HudFixed { fps, 1 });
+                stats_hud.set_line(3, line.clear() << "Iterations: " << solver_stats.iterations << "/" << solver.settings.max_iterations);
+                stats_hud.set_line(4, line.clear() << "Max Error: " << solver_stats.max_error);
+                stats_hud.set_line(6, line.clear() << "Multigrid Levels: " << solver_stats.multigrid_levels);
+                stats_hud.set_line(7, line.clear() << "Tethers: " << solver_stats.tethers);
+                // 各类约束的求解周期与耗时
+                for (int t = 0; t < CONSTRAINT_TYPE_COUNT; ++t) {
+                    int period = solver.settings.batch_period[t];
+                    line.clear() << constraint_type_name(static_cast<ConstraintType>(t)) << ": ";
+                    if (period <= 0)
+                        line << "1/frame";
+                    else
+                        line << "1/" << period << " it";
+                    line << ", " << solver_stats.batch_sweeps[t] << " sweeps, " << HudFixed { solver_stats.batch_ms[t], 3 } << " ms";
+                    stats_hud.set_line(batch_row + t, line);
+                }
+            }
+            size_t row = batch_row + CONSTRAINT_TYPE_COUNT;
+            if (scene_mode)
+                stats_hud.set_line(row++, line.clear() << "Scene: " << scene.get_instances().size() << " cloths (Verlet)");
+            if (refresh && recording)
+                stats_hud.set_line(row, line.clear() << "Recording: frame " << frame);
+            else if (refresh && replaying)
+                stats_hud.set_line(row, line.clear() << "Replay: frame " << frame << "/" << input_log.get_frames());
+            stats_hud.draw(window, sf::Vector2f(static_cast<float>(current_win_width - 350), 20.f)); // 右上角
+            // 绘制操作说明（右下角，英文），内容固定，只排版一次
+            if (help_hud.line_count() == 0) {
+                const char* help_lines[] = {
+                    "Left click: Drag particle",
+                    "Right click: Pin/unpin",
+                    "Middle click: Pan",
+                    "Mouse wheel: Zoom",
+                    "R: Reset cloth",
+                    "+/-: Gravity",
+                    "[ ]: Wind",
+                    ", .: Solver iterations",
+                    "C: Chebyshev acceleration",
+                    "M: Multigrid solver",
+                    "K: Auto tearing by strain",
+                    "E: Cycle integrator",
+                    "G: Stadium scene",
+                    "V: Shaded surface",
+                    "F5: Record input / F6: Replay",
+                    "WASD: Rotate view",
+                    "Space: Toggle wind",
+                    "T: Triangle grid",
+                    "H: Hex grid",
+                    "Q: Square grid",
+                    "Ctrl+S: Save cloth",
+                    "Ctrl+L: Load cloth",
+                };
+                for (size_t i = 0; i < std::size(help_lines); ++i)
+                    help_hud.set_line(i, help_lines[i]);
+            }
+            help_hud.draw(window, sf::Vector2f(current_win_width - help_hud.width() - 40.f, current_win_height - help_hud.height() - 80.f));
             // 绘制坐标轴（加粗版 - Fixed)
             sf::Vector2f origin_2d(80, 120); // Top-left corner screen position
             float axis_len = 50; // Screen length of the axis representation
@@ -734,40 +1078,20 @@ int main()
 
             // 绘制左下角动态信息
             if (display_info_message) {
-                std::stringstream ss;
-                ss << "Cam Pos: (" << cam_pos.x << ", " << cam_pos.y << ", " << cam_pos.z << ")\n"
-                   << "Cam Yaw: " << cam_yaw << "\n"
-                   << "Cam Pitch: " << cam_pitch << "\n"
-                   << "Grid: ";
-                if (grid_type == GridType::Square)
-                    ss << "Square";
-                else if (grid_type == GridType::Triangle)
-                    ss << "Triangle";
-                else if (grid_type == GridType::Hexagon)
-                    ss << "Hexagon";
-                ss << "\nParticles: " << particles.size();
-                ss << "\nConstraints: " << constraints.size();
-                std::string dynamic_info_str = ss.str(); // 从 stringstream 获取最终字符串
-
-                sf::Text bottomLeftInfo(font, dynamic_info_str);
-                bottomLeftInfo.setFillColor(sf::Color::Yellow);
-                bottomLeftInfo.setCharacterSize(18);
-
-                // 重新计算行数以确定位置
-                int line_count = 1; // 从1开始计数
-                for (char ch : dynamic_info_str) {
-                    if (ch == '\n') {
-                        line_count++;
-                    }
+                if (refresh || info_hud.line_count() == 0) {
+                    info_hud.set_line(0, line.clear() << "Cam Pos: (" << cam_pos.x << ", " << cam_pos.y << ", " << cam_pos.z << ")");
+                    info_hud.set_line(1, line.clear() << "Cam Yaw: " << cam_yaw);
+                    info_hud.set_line(2, line.clear() << "Cam Pitch: " << cam_pitch);
+                    info_hud.set_line(3, line.clear() << "Grid: " << grid_type_name(grid_type));
+                    info_hud.set_line(4, line.clear() << "Particles: " << particles.size());
+                    info_hud.set_line(5, line.clear() << "Constraints: " << constraints.size());
+                    info_hud.set_line(6, line.clear() << "Dihedrals: " << dihedrals.size());
                 }
-
-                float text_height = line_count * bottomLeftInfo.getCharacterSize() * 1.15f; // Approximate height with line spacing
-
-                bottomLeftInfo.setPosition(sf::Vector2f(20.f, current_win_height - text_height - 20.f));
-                window.draw(bottomLeftInfo);
+                info_hud.draw(window, sf::Vector2f(20.f, current_win_height - info_hud.height() - 20.f));
             }
         }
 
         window.display();
     }
+    TaskScheduler::instance().wait(physics_job);
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef MATRIX3F_H
+#define MATRIX3F_H
+#include "vector3f.h"
+
+// 3x3 矩阵（行优先），用于隐式积分的块稀疏矩阵
+struct Matrix3f {
+    float m[3][3];
+    Matrix3f(float diag = 0)
+        : m { { diag, 0, 0 }, { 0, diag, 0 }, { 0, 0, diag } }
+    {
+    }
+    static Matrix3f outer(const Vector3f& a, const Vector3f& b)
+    {
+        Matrix3f r;
+        const float av[3] = { a.x, a.y, a.z };
+        const float bv[3] = { b.x, b.y, b.z };
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = av[i] * bv[j];
+        return r;
+    }
+    Matrix3f operator+(const Matrix3f& rhs) const
+    {
+        Matrix3f r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[i][j] + rhs.m[i][j];
+        return r;
+    }
+    Matrix3f operator-(const Matrix3f& rhs) const
+    {
+        Matrix3f r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[i][j] - rhs.m[i][j];
+        return r;
+    }
+    Matrix3f operator*(float s) const
+    {
+        Matrix3f r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[i][j] * s;
+        return r;
+    }
+    Matrix3f& operator+=(const Matrix3f& rhs)
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                m[i][j] += rhs.m[i][j];
+        return *this;
+    }
+    Vector3f operator*(const Vector3f& v) const
+    {
+        return Vector3f(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+            m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+            m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+    }
+    // 对称正定块求逆（伴随矩阵法），奇异时返回单位阵
+    Matrix3f inverse() const
+    {
+        Matrix3f r;
+        r.m[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        r.m[0][1] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+        r.m[0][2] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+        r.m[1][0] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        r.m[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+        r.m[1][2] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+        r.m[2][0] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        r.m[2][1] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+        r.m[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+        float det = m[0][0] * r.m[0][0] + m[0][1] * r.m[1][0] + m[0][2] * r.m[2][0];
+        if (det == 0)
+            return Matrix3f(1.0f);
+        return r * (1.0f / det);
+    }
+};
+
+#endif // MATRIX3F_H
@@ -0,0 +1,125 @@
+#include "mesh_order.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace {
+// 10 位整数的各位之间插入两个 0
+uint32_t spread_bits(uint32_t v)
+{
+    v &= 0x3FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+// 包围盒内每轴量化为 10 位后交错成 30 位 Morton 码
+std::vector<uint32_t> morton_codes(const std::vector<Particle>& particles)
+{
+    Vector3f lo = particles[0].position, hi = lo;
+    for (const auto& p : particles) {
+        lo = Vector3f(std::min(lo.x, p.position.x), std::min(lo.y, p.position.y), std::min(lo.z, p.position.z));
+        hi = Vector3f(std::max(hi.x, p.position.x), std::max(hi.y, p.position.y), std::max(hi.z, p.position.z));
+    }
+    const float extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z });
+    const float scale = extent > 0.0f ? 1023.0f / extent : 0.0f;
+    std::vector<uint32_t> codes(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        const Vector3f q = (particles[i].position - lo) * scale;
+        codes[i] = spread_bits(static_cast<uint32_t>(q.x)) | (spread_bits(static_cast<uint32_t>(q.y)) << 1)
+            | (spread_bits(static_cast<uint32_t>(q.z)) << 2);
+    }
+    return codes;
+}
+}
+
+void reorder_mesh(std::vector<Particle>& particles, std::vector<Constraint>& constraints)
+{
+    if (particles.empty())
+        return;
+    const size_t n = particles.size();
+
+    // 粒子按 Morton 码排序，码相同时保持原顺序
+    const std::vector<uint32_t> codes = morton_codes(particles);
+    std::vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return codes[a] != codes[b] ? codes[a] < codes[b] : a < b; });
+    std::vector<uint32_t> remap(n);
+    std::vector<Particle> sorted;
+    sorted.reserve(n);
+    for (uint32_t k = 0; k < n; ++k) {
+        remap[order[k]] = k;
+        sorted.push_back(particles[order[k]]);
+    }
+
+    // 约束改指向新下标，以较小的下标为第一个端点（两端对调不改变投影结果）
+    const size_t m = constraints.size();
+    const Particle* old_base = particles.data();
+    std::vector<uint32_t> first(m), second(m);
+    for (size_t k = 0; k < m; ++k) {
+        uint32_t a = remap[constraints[k].p1 - old_base], b = remap[constraints[k].p2 - old_base];
+        first[k] = std::min(a, b);
+        second[k] = std::max(a, b);
+    }
+    particles = std::move(sorted);
+
+    // 按（类别，第一个端点）计数排序，第一个端点相同的几条再按第二个端点排
+    auto bucket = [&](size_t k) { return static_cast<size_t>(constraints[k].type) * n + first[k]; };
+    std::vector<uint32_t> start(CONSTRAINT_TYPE_COUNT * n + 1);
+    for (size_t k = 0; k < m; ++k)
+        ++start[bucket(k) + 1];
+    for (size_t b = 1; b < start.size(); ++b)
+        start[b] += start[b - 1];
+    std::vector<uint32_t> by_endpoint(m);
+    {
+        std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (uint32_t k = 0; k < m; ++k)
+            by_endpoint[fill[bucket(k)]++] = k;
+    }
+    for (size_t b = 0; b + 1 < start.size(); ++b) {
+        if (start[b + 1] - start[b] > 1)
+            std::sort(by_endpoint.begin() + start[b], by_endpoint.begin() + start[b + 1],
+                [&](uint32_t x, uint32_t y) { return second[x] != second[y] ? second[x] < second[y] : x < y; });
+    }
+
+    // 按上面的顺序逐类贪心着色：取两端粒子都还没用过的最小颜色，64 种用完时留作未着色，排在该类最后串行求解
+    std::vector<uint8_t> color(m);
+    std::vector<uint64_t> used(n);
+    for (size_t i = 0; i < m; ++i) {
+        const uint32_t k = by_endpoint[i];
+        if (i > 0 && constraints[k].type != constraints[by_endpoint[i - 1]].type)
+            std::fill(used.begin(), used.end(), 0);
+        const uint64_t free = ~(used[first[k]] | used[second[k]]);
+        if (free == 0) {
+            color[k] = Constraint::NO_COLOR;
+            continue;
+        }
+        color[k] = static_cast<uint8_t>(std::countr_zero(free));
+        used[first[k]] |= uint64_t(1) << color[k];
+        used[second[k]] |= uint64_t(1) << color[k];
+    }
+
+    // 再按（类别，颜色）稳定地计数排序，同色组内保持第一个端点的顺序
+    const size_t slots = 65; // 64 种颜色加未着色
+    auto group = [&](uint32_t k) { return static_cast<size_t>(constraints[k].type) * slots + std::min<size_t>(color[k], slots - 1); };
+    std::vector<size_t> offset(CONSTRAINT_TYPE_COUNT * slots + 1);
+    for (size_t k = 0; k < m; ++k)
+        ++offset[group(static_cast<uint32_t>(k)) + 1];
+    for (size_t g = 1; g < offset.size(); ++g)
+        offset[g] += offset[g - 1];
+    std::vector<uint32_t> final_order(m);
+    for (uint32_t k : by_endpoint)
+        final_order[offset[group(k)]++] = k;
+    std::vector<Constraint> result;
+    result.reserve(m);
+    for (uint32_t k : final_order) {
+        result.push_back(constraints[k]);
+        result.back().p1 = particles.data() + first[k];
+        result.back().p2 = particles.data() + second[k];
+        result.back().color = color[k];
+    }
+    constraints = std::move(result);
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "constraint.h"
+#include "particle.h"
+#include <vector>
+
+// 导入网格的访存顺序整理。文件里的粒子、约束顺序任意，直接扫描约束会在粒子数组里随机跳转：
+// 粒子按位置的 Morton 码重排，空间上相邻的粒子在数组里也相邻；约束改指向新下标并以较小的下标为第一个端点，
+// 按类别分批、批内贪心着色，同色组内按第一个端点排序。求解器扫描时顺序走过粒子数组，同色组还可以并行
+void reorder_mesh(std::vector<Particle>& particles, std::vector<Constraint>& constraints);
@@ -0,0 +1,174 @@
+#include "multigrid.h"
+#include <algorithm>
+#include <cmath>
+
+void Multigrid::set_grid(int rows_, int cols_, GridType type_)
+{
+    rows = rows_;
+    cols = cols_;
+    type = type_;
+    levels.clear();
+    valid = false;
+    built_particles = 0;
+    built_active = 0;
+}
+
+bool Multigrid::prepare(std::span<const Particle> particles, std::span<const Constraint> constraints, size_t active_count)
+{
+    if (rows < 3 || cols < 3 || particles.size() != static_cast<size_t>(rows) * cols)
+        return false;
+    if (built_particles == particles.size() && built_active == active_count)
+        return valid;
+    built_particles = particles.size();
+    built_active = active_count;
+    valid = build(particles, constraints);
+    return valid;
+}
+
+// 粗层连杆的静止长度取网格静止位置之差；细网格路径上的横向/纵向约束须全部有效，
+// 否则说明布料已撕开，层级不再可靠
+bool Multigrid::build(std::span<const Particle> particles, std::span<const Constraint> constraints)
+{
+    levels.clear();
+    const int n = rows * cols;
+    std::vector<float> horizontal(n, -1.0f); // idx -> idx + 1
+    std::vector<float> vertical(n, -1.0f); // idx -> idx + cols
+    const Particle* base = particles.data();
+    for (const auto& c : constraints) {
+        if (!c.active || c.type != ConstraintType::Structural)
+            continue;
+        int i = static_cast<int>(c.p1 - base);
+        int j = static_cast<int>(c.p2 - base);
+        if (i > j)
+            std::swap(i, j);
+        if (j == i + 1 && i % cols != cols - 1)
+            horizontal[i] = c.initial_length;
+        else if (j == i + cols)
+            vertical[i] = c.initial_length;
+    }
+
+    // 由任一横向约束反推静止间距（六边形网格的横向间距为 0.866 倍）
+    const float unit = (grid_rest_position(type, 0, 1, 1.0f) - grid_rest_position(type, 0, 0, 1.0f)).length();
+    float spacing = -1.0f;
+    for (float h : horizontal) {
+        if (h > 0.0f) {
+            spacing = h / unit;
+            break;
+        }
+    }
+    if (spacing <= 0.0f)
+        return false;
+    auto rest = [&](int r, int c) { return grid_rest_position(type, r, c, spacing); };
+
+    for (int stride = 2;; stride *= 2) {
+        Level level;
+        level.stride = stride;
+        level.rows = (rows - 1) / stride + 1;
+        level.cols = (cols - 1) / stride + 1;
+        if (level.rows < 3 || level.cols < 3)
+            break;
+
+        // 粗层相邻节点间的细网格路径是否完好
+        auto path_intact = [&](int r, int c, bool along_row) {
+            for (int k = 0; k < stride; ++k) {
+                int idx = along_row ? (r * cols + c + k) : ((r + k) * cols + c);
+                if ((along_row ? horizontal[idx] : vertical[idx]) < 0.0f)
+                    return false;
+            }
+            return true;
+        };
+
+        for (int r = 0; r < level.rows; ++r) {
+            for (int c = 0; c < level.cols; ++c) {
+                int idx = r * level.cols + c;
+                int fr = r * stride, fc = c * stride;
+                bool right = c < level.cols - 1, down = r < level.rows - 1;
+                if ((right && !path_intact(fr, fc, true)) || (down && !path_intact(fr, fc, false)))
+                    return false; // 存在断开的约束，层级不再可靠
+                const Vector3f p = rest(fr, fc);
+                if (right)
+                    level.links.push_back({ idx, idx + 1, (rest(fr, fc + stride) - p).length() });
+                if (down)
+                    level.links.push_back({ idx, idx + level.cols, (rest(fr + stride, fc) - p).length() });
+                // 对角连杆提供抗剪切，避免粗层塌缩
+                if (right && down) {
+                    level.links.push_back({ idx, idx + level.cols + 1, (rest(fr + stride, fc + stride) - p).length() });
+                    level.links.push_back({ idx + 1, idx + level.cols, (rest(fr + stride, fc) - rest(fr, fc + stride)).length() });
+                }
+            }
+        }
+        const size_t count = static_cast<size_t>(level.rows) * level.cols;
+        level.positions.resize(count);
+        level.corrections.resize(count);
+        level.pinned.resize(count);
+        levels.push_back(std::move(level));
+    }
+    return !levels.empty();
+}
+
+// 把粗层节点的位移双线性插值到所有细层粒子
+void Multigrid::prolong(const Level& level, std::span<Particle> particles) const
+{
+    const float inv_stride = 1.0f / level.stride;
+    for (int r = 0; r < rows; ++r) {
+        float fr = r * inv_stride;
+        int r0 = std::min(static_cast<int>(fr), level.rows - 1);
+        int r1 = std::min(r0 + 1, level.rows - 1);
+        float tr = std::min(fr - r0, 1.0f);
+        for (int c = 0; c < cols; ++c) {
+            Particle& p = particles[r * cols + c];
+            if (p.is_pinned)
+                continue;
+            float fc = c * inv_stride;
+            int c0 = std::min(static_cast<int>(fc), level.cols - 1);
+            int c1 = std::min(c0 + 1, level.cols - 1);
+            float tc = std::min(fc - c0, 1.0f);
+            const Vector3f& d00 = level.corrections[r0 * level.cols + c0];
+            const Vector3f& d01 = level.corrections[r0 * level.cols + c1];
+            const Vector3f& d10 = level.corrections[r1 * level.cols + c0];
+            const Vector3f& d11 = level.corrections[r1 * level.cols + c1];
+            Vector3f top = d00 * (1.0f - tc) + d01 * tc;
+            Vector3f bottom = d10 * (1.0f - tc) + d11 * tc;
+            p.position += top * (1.0f - tr) + bottom * tr;
+        }
+    }
+}
+
+void Multigrid::solve(std::span<Particle> particles, int iterations, float relaxation)
+{
+    if (!valid)
+        return;
+    for (auto it = levels.rbegin(); it != levels.rend(); ++it) {
+        Level& level = *it;
+        // 限制：直接取对应细层粒子的当前位置
+        for (int r = 0; r < level.rows; ++r) {
+            for (int c = 0; c < level.cols; ++c) {
+                const Particle& p = particles[(r * level.stride) * cols + c * level.stride];
+                int idx = r * level.cols + c;
+                level.positions[idx] = p.position;
+                level.corrections[idx] = p.position;
+                level.pinned[idx] = p.is_pinned;
+            }
+        }
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& link : level.links) {
+                Vector3f& a = level.positions[link.a];
+                Vector3f& b = level.positions[link.b];
+                Vector3f delta = b - a;
+                float len = delta.length();
+                if (len == 0)
+                    continue;
+                float wa = level.pinned[link.a] ? 0.0f : 1.0f;
+                float wb = level.pinned[link.b] ? 0.0f : 1.0f;
+                if (wa + wb == 0.0f)
+                    continue;
+                Vector3f correction = delta * ((len - link.rest_length) / len / (wa + wb) * relaxation);
+                a += correction * wa;
+                b -= correction * wb;
+            }
+        }
+        for (size_t i = 0; i < level.positions.size(); ++i)
+            level.corrections[i] = level.positions[i] - level.corrections[i];
+        prolong(level, particles);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "constraint.h"
+#include "grid_topology.h"
+#include "particle.h"
+#include <span>
+#include <vector>
+
+// 规则网格的多分辨率约束求解：
+// 每隔 2^l 行/列取一个粒子组成第 l 层粗网格，由粗到细依次求解，
+// 并把粗层节点的位移用双线性插值延拓到全部细层粒子上。
+class Multigrid {
+public:
+    // 设置网格行列数和类型（粒子按 row * cols + col 排列），rows/cols 为 0 时禁用
+    void set_grid(int rows, int cols, GridType type = GridType::Square);
+
+    // 检查层级是否与当前拓扑一致，必要时重建；撕裂或导入的网格返回 false
+    bool prepare(std::span<const Particle> particles, std::span<const Constraint> constraints, size_t active_count);
+
+    // 由粗到细求解各粗层，每层迭代 iterations 次
+    void solve(std::span<Particle> particles, int iterations, float relaxation);
+
+    int level_count() const { return static_cast<int>(levels.size()); }
+
+private:
+    struct Link {
+        int a, b; // 本层节点下标
+        float rest_length;
+    };
+    struct Level {
+        int rows, cols;
+        int stride; // 相邻节点在细网格中的行列间隔
+        std::vector<Link> links;
+        std::vector<Vector3f> positions;
+        std::vector<Vector3f> corrections;
+        std::vector<char> pinned;
+    };
+
+    int rows = 0, cols = 0;
+    GridType type = GridType::Square;
+    bool valid = false;
+    size_t built_particles = 0;
+    size_t built_active = 0;
+    std::vector<Level> levels;
+
+    bool build(std::span<const Particle> particles, std::span<const Constraint> constraints);
+    void prolong(const Level& level, std::span<Particle> particles) const;
+};
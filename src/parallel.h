@@ -0,0 +1,120 @@
+#pragma once
+#include "task_scheduler.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// 数据并行工具：把 [0, count) 切成若干连续块，作为任务交给共用的 TaskScheduler。
+// 数据量小于 min_chunk * 2 时直接在调用线程上执行。
+
+// 确定性模式下的分块数上限，与机器核数无关
+const size_t DETERMINISTIC_CHUNKS = 8;
+
+// 确定性模式：分块方式只取决于数据量，按块序归约的结果在不同机器上逐位一致
+inline bool& parallel_deterministic()
+{
+    static bool enabled = false;
+    return enabled;
+}
+
+inline void set_parallel_deterministic(bool enabled)
+{
+    parallel_deterministic() = enabled;
+}
+
+// 缓存行字节数
+const size_t CACHE_LINE = 64;
+
+// 按缓存行对齐的分配器：块边界也落在缓存行上时，相邻块的线程不会写同一行
+template <typename T>
+struct CacheAlignedAllocator {
+    using value_type = T;
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) { }
+
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(CACHE_LINE)); }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+};
+
+inline size_t parallel_chunk_count(size_t count, size_t min_chunk)
+{
+    size_t workers = parallel_deterministic() ? DETERMINISTIC_CHUNKS : TaskScheduler::instance().worker_count() + 1;
+    return std::clamp<size_t>(count / std::max<size_t>(min_chunk, 1), 1, workers);
+}
+
+// fn(chunk, begin, end)
+template <typename Fn>
+void parallel_for_chunks(size_t count, size_t min_chunk, Fn&& fn)
+{
+    const size_t chunks = parallel_chunk_count(count, min_chunk);
+    if (chunks <= 1) {
+        fn(size_t(0), size_t(0), count);
+        return;
+    }
+    TaskScheduler::instance().run_batch(chunks, [&fn, count, chunks](size_t k) {
+        fn(k, count * k / chunks, count * (k + 1) / chunks);
+    });
+}
+
+// fn(i)
+template <typename Fn>
+void parallel_for(size_t count, size_t min_chunk, Fn&& fn)
+{
+    parallel_for_chunks(count, min_chunk, [&fn](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            fn(i);
+    });
+}
+
+// 按块求和后再按块序累加，结果与线程调度无关
+template <typename T, typename Fn>
+T parallel_sum(size_t count, size_t min_chunk, Fn&& fn)
+{
+    ScratchArena& arena = TaskScheduler::scratch();
+    ScratchScope scope(arena);
+    std::span<T> partial = arena.allocate<T>(parallel_chunk_count(count, min_chunk));
+    parallel_for_chunks(count, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        T sum(0);
+        for (size_t i = begin; i < end; ++i)
+            sum += fn(i);
+        partial[chunk] = sum;
+    });
+    T total(0);
+    for (const T& p : partial)
+        total += p;
+    return total;
+}
+
+// 并行筛选输出：fn(i, dst) 向 dst 写入至多 max_per_item 个元素并返回写入个数。
+// 各块先写在自己的区段内，再按块序前移拼接，输出顺序与串行执行一致
+template <typename T, typename Fn>
+void parallel_compact(size_t count, size_t min_chunk, size_t max_per_item, std::vector<T>& out, Fn&& fn)
+{
+    ScratchArena& arena = TaskScheduler::scratch();
+    ScratchScope scope(arena);
+    const size_t chunks = parallel_chunk_count(count, min_chunk);
+    std::span<size_t> begins = arena.allocate<size_t>(chunks);
+    std::span<size_t> written = arena.allocate<size_t>(chunks);
+    out.resize(count * max_per_item);
+    parallel_for_chunks(count, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        T* dst = out.data() + begin * max_per_item;
+        size_t n = 0;
+        for (size_t i = begin; i < end; ++i)
+            n += fn(i, dst + n);
+        begins[chunk] = begin * max_per_item;
+        written[chunk] = n;
+    });
+    size_t total = 0;
+    for (size_t k = 0; k < chunks; ++k) {
+        if (begins[k] != total)
+            std::copy_n(out.begin() + begins[k], written[k], out.begin() + total);
+        total += written[k];
+    }
+    out.resize(total);
+}
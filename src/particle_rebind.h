@@ -0,0 +1,36 @@
+#pragma once
+#include "particle.h"
+#include <cstddef>
+#include <cstdint>
+
+// 粒子数组搬家（扩容、拼接）后，把约束里指向旧数组 [old_base, old_base + count) 的粒子指针平移到 new_base。
+// 旧数组此时通常已经释放，所以旧地址以整数传入，只比较地址值，不再用指针与已释放的内存比较。
+// 适用于距离约束（p1, p2）和二面角约束（p1..p4）
+template <typename Range>
+void rebind_particles(Range& items, std::uintptr_t old_base, size_t count, Particle* new_base)
+{
+    const std::uintptr_t old_end = old_base + count * sizeof(Particle);
+    auto move = [&](Particle*& p) {
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        if (address >= old_base && address < old_end)
+            p = new_base + (address - old_base) / sizeof(Particle);
+    };
+    for (auto& item : items) {
+        if constexpr (requires { item.p3; }) {
+            move(item.p1);
+            move(item.p2);
+            move(item.p3);
+            move(item.p4);
+        } else {
+            move(item.p1);
+            move(item.p2);
+        }
+    }
+}
+
+// 旧数组仍然有效时（例如从局部数组拼接进来）可以直接传指针
+template <typename Range>
+void rebind_particles(Range& items, const Particle* old_base, size_t count, Particle* new_base)
+{
+    rebind_particles(items, reinterpret_cast<std::uintptr_t>(old_base), count, new_base);
+}
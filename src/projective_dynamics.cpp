@@ -0,0 +1,212 @@
+#include "projective_dynamics.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t MIN_CHUNK = 4096;
+
+uint64_t spring_key(int a, int b)
+{
+    if (a > b)
+        std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+}
+}
+
+void ProjectiveDynamics::collect_springs(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints)
+{
+    const Particle* base = particles.data();
+    springs.clear();
+    spring_keys.clear();
+    for (const auto& c : constraints) {
+        if (!c.active)
+            continue;
+        int a = static_cast<int>(c.p1 - base);
+        int b = static_cast<int>(c.p2 - base);
+        springs.push_back({ a, b, c.initial_length, c.stiffness, c.type });
+        spring_keys.push_back({ spring_key(a, b), c.stiffness });
+    }
+    std::sort(spring_keys.begin(), spring_keys.end());
+}
+
+void ProjectiveDynamics::build_incidence(size_t particle_count)
+{
+    incident_offsets.assign(particle_count + 1, 0);
+    for (const auto& s : springs) {
+        incident_offsets[s.a + 1]++;
+        incident_offsets[s.b + 1]++;
+    }
+    for (size_t i = 0; i < particle_count; ++i)
+        incident_offsets[i + 1] += incident_offsets[i];
+    incident.resize(incident_offsets[particle_count]);
+    std::vector<int> fill(incident_offsets.begin(), incident_offsets.end() - 1);
+    for (size_t s = 0; s < springs.size(); ++s) {
+        incident[fill[springs[s].a]++] = static_cast<int>(s * 2);
+        incident[fill[springs[s].b]++] = static_cast<int>(s * 2 + 1);
+    }
+}
+
+void ProjectiveDynamics::refactor(const std::vector<Particle>& particles, float h)
+{
+    const int n = static_cast<int>(particles.size());
+    std::vector<std::pair<int, int>> edges;
+    std::vector<double> weights;
+    edges.reserve(springs.size());
+    weights.reserve(springs.size());
+    for (const auto& s : springs) {
+        edges.push_back({ s.a, s.b });
+        weights.push_back(static_cast<double>(stiffness) * s.weight);
+    }
+    std::vector<double> diag(n);
+    pinned.resize(n);
+    for (int i = 0; i < n; ++i) {
+        pinned[i] = particles[i].is_pinned;
+        diag[i] = 1.0 / (static_cast<double>(h) * h) + (pinned[i] ? pin_weight : 0.0);
+    }
+    cholesky.analyze(n, edges);
+    cholesky.factor(diag, edges, weights);
+    factored_h = h;
+    factored_stiffness = stiffness;
+    factored_pin_weight = pin_weight;
+    ++factorizations;
+}
+
+// 对比上次分解时的拓扑，能增量修改就不重新分解
+void ProjectiveDynamics::sync_topology(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float h)
+{
+    size_t active = std::count_if(constraints.begin(), constraints.end(), [](const Constraint& c) { return c.active; });
+    bool full = !cholesky.is_valid() || cholesky.size() != static_cast<int>(particles.size()) || h != factored_h
+        || stiffness != factored_stiffness || pin_weight != factored_pin_weight;
+
+    // 计数只是兜底：数量不变的拓扑修改要靠调用方 invalidate()
+    if (!full && (topology_dirty || constraints.size() != factored_constraints || active != factored_active)) {
+        auto old_keys = std::move(spring_keys);
+        collect_springs(particles, constraints);
+        decltype(spring_keys) removed, added;
+        std::set_difference(old_keys.begin(), old_keys.end(), spring_keys.begin(), spring_keys.end(), std::back_inserter(removed));
+        std::set_difference(spring_keys.begin(), spring_keys.end(), old_keys.begin(), old_keys.end(), std::back_inserter(added));
+        // 新增的边可能落在包络之外，只能重新分解
+        full = !added.empty();
+        for (size_t i = 0; i < removed.size() && !full; ++i) {
+            int a = static_cast<int>(removed[i].first >> 32);
+            int b = static_cast<int>(removed[i].first & 0xffffffffu);
+            full = !cholesky.rank_one(a, b, static_cast<double>(stiffness) * removed[i].second, -1.0);
+            ++rank_updates;
+        }
+        build_incidence(particles.size());
+    } else if (full) {
+        collect_springs(particles, constraints);
+        build_incidence(particles.size());
+    }
+    topology_dirty = false;
+
+    if (full) {
+        refactor(particles, h);
+    } else {
+        for (size_t i = 0; i < particles.size(); ++i) {
+            if (pinned[i] == particles[i].is_pinned)
+                continue;
+            pinned[i] = particles[i].is_pinned;
+            if (!cholesky.rank_one(static_cast<int>(i), -1, pin_weight, pinned[i] ? 1.0 : -1.0)) {
+                refactor(particles, h);
+                break;
+            }
+            ++rank_updates;
+        }
+    }
+    factored_constraints = constraints.size();
+    factored_active = active;
+}
+
+SolverStats ProjectiveDynamics::step(std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float h, const SolverSettings& settings)
+{
+    SolverStats stats;
+    const size_t n = particles.size();
+    if (n == 0)
+        return stats;
+    sync_topology(particles, constraints, h);
+
+    // 惯性预测 y = x + v h + a h^2，作为迭代初值
+    inertial.resize(n);
+    for (auto& r : rhs)
+        r.resize(n);
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        Particle& p = particles[i];
+        inertial[i] = p.is_pinned ? p.position : p.position + (p.position - p.previous_position) + p.acceleration * (h * h);
+        p.previous_position = p.position;
+        p.position = inertial[i];
+        p.acceleration = Vector3f(0, 0, 0);
+    });
+
+    const float inv_h2 = 1.0f / (h * h);
+    projections.resize(springs.size());
+    const size_t chunks = parallel_chunk_count(springs.size(), MIN_CHUNK);
+    ScratchArena& arena = TaskScheduler::scratch();
+    ScratchScope scope(arena);
+    std::span<float> chunk_max = arena.allocate<float>(chunks);
+    std::span<float> chunk_sum = arena.allocate<float>(chunks);
+    std::span<size_t> chunk_measured = arena.allocate<size_t>(chunks);
+
+    for (int k = 0; k < settings.max_iterations; ++k) {
+        // 局部步：每条约束独立投影到静止长度，同时统计结构约束的误差（与 ConstraintSolver 一致）
+        parallel_for_chunks(springs.size(), MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+            float max_error = 0.0f, sum_sq = 0.0f;
+            size_t measured = 0;
+            for (size_t s = begin; s < end; ++s) {
+                const Spring& sp = springs[s];
+                Vector3f d = particles[sp.a].position - particles[sp.b].position;
+                float len = d.length();
+                projections[s] = len > 0 ? d * (sp.rest_length / len) : Vector3f();
+                if (sp.type != ConstraintType::Structural)
+                    continue;
+                float e = std::abs(len - sp.rest_length) / sp.rest_length;
+                max_error = std::max(max_error, e);
+                sum_sq += e * e;
+                ++measured;
+            }
+            chunk_max[chunk] = max_error;
+            chunk_sum[chunk] = sum_sq;
+            chunk_measured[chunk] = measured;
+        });
+        float max_error = 0.0f, sum_sq = 0.0f;
+        size_t measured = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            max_error = std::max(max_error, chunk_max[c]);
+            sum_sq += chunk_sum[c];
+            measured += chunk_measured[c];
+        }
+        stats.iterations = k + 1;
+        stats.max_error = max_error;
+        stats.rms_error = measured > 0 ? std::sqrt(sum_sq / measured) : 0.0f;
+        if (max_error < settings.tolerance)
+            break;
+
+        // 全局步：组装右端项后回代求解三个坐标分量
+        parallel_for(n, MIN_CHUNK, [&](size_t i) {
+            Vector3f b = inertial[i] * inv_h2;
+            if (pinned[i])
+                b += particles[i].position * pin_weight;
+            Vector3f spring_sum;
+            for (int e = incident_offsets[i]; e < incident_offsets[i + 1]; ++e) {
+                int s = incident[e];
+                Vector3f p = projections[s >> 1] * springs[s >> 1].weight;
+                if (s & 1)
+                    spring_sum -= p;
+                else
+                    spring_sum += p;
+            }
+            b += spring_sum * stiffness;
+            rhs[0][i] = b.x;
+            rhs[1][i] = b.y;
+            rhs[2][i] = b.z;
+        });
+        parallel_for(3, 1, [&](size_t axis) { cholesky.solve(rhs[axis], scratch[axis]); });
+        parallel_for(n, MIN_CHUNK, [&](size_t i) {
+            Particle& p = particles[i];
+            if (!p.is_pinned)
+                p.position.set(static_cast<float>(rhs[0][i]), static_cast<float>(rhs[1][i]), static_cast<float>(rhs[2][i]));
+        });
+    }
+    return stats;
+}
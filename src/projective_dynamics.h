@@ -0,0 +1,59 @@
+#pragma once
+#include "constants.h"
+#include "constraint.h"
+#include "particle.h"
+#include "solver.h"
+#include "sparse_cholesky.h"
+#include <cstdint>
+#include <vector>
+
+// 投影动力学（Projective Dynamics）求解器：
+// 全局矩阵 A = M/h^2 + k Σ (e_a - e_b)(e_a - e_b)^T + w Σ_固定 e_i e_i^T 只在拓扑变化时修改，
+// 预先做稀疏 Cholesky 分解；每次迭代先并行投影所有约束（局部步），再回代求解（全局步）。
+// 约束失效（deactivate / 撕裂删除）与固定状态切换通过秩一降秩/更新增量修改分解。
+class ProjectiveDynamics {
+public:
+    float stiffness = PD_STIFFNESS; // 约束权重
+    float pin_weight = PD_PIN_WEIGHT; // 固定粒子的附着权重
+
+    // 一个完整时间步（积分 + 约束求解），迭代次数与收敛阈值取自 settings
+    SolverStats step(std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float time_step, const SolverSettings& settings);
+    // 拓扑变化（重置、加载、撕裂）后调用：下一步重新收集弹簧并与分解时的拓扑比对。
+    // 只删边时仍走降秩更新；加载重排粒子后边集变了，会重新分解
+    void invalidate() { topology_dirty = true; }
+
+    int get_factorizations() const { return factorizations; } // 完整分解次数
+    int get_rank_updates() const { return rank_updates; } // 增量更新次数
+
+private:
+    struct Spring {
+        int a, b;
+        float rest_length;
+        float weight; // 约束自身的相对刚度
+        ConstraintType type; // 只有结构约束计入误差统计
+    };
+    std::vector<Spring> springs;
+    std::vector<std::pair<uint64_t, float>> spring_keys; // 按 (a, b) 键排序的 (键, 相对刚度)，用于比对拓扑变化
+    std::vector<int> incident_offsets; // 每个粒子关联的弹簧（CSR）
+    std::vector<int> incident; // 弹簧下标 * 2 + (是否为 b 端)
+    std::vector<char> pinned;
+    size_t factored_constraints = 0;
+    size_t factored_active = 0;
+    float factored_h = 0.0f;
+    float factored_stiffness = 0.0f;
+    float factored_pin_weight = 0.0f;
+    bool topology_dirty = false;
+    SparseCholesky cholesky;
+    int factorizations = 0;
+    int rank_updates = 0;
+
+    std::vector<Vector3f> inertial;
+    std::vector<Vector3f> projections;
+    std::vector<double> rhs[3];
+    std::vector<double> scratch[3];
+
+    void collect_springs(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints);
+    void build_incidence(size_t particle_count);
+    void refactor(const std::vector<Particle>& particles, float h);
+    void sync_topology(const std::vector<Particle>& particles, const std::vector<Constraint>& constraints, float h);
+};
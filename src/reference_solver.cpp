@@ -0,0 +1,47 @@
+#include "reference_solver.h"
+
+// 基线 Particle::apply_force + Particle::update 的逐字副本
+static void reference_update(Particle& p, const Vector3f& force, float time_step)
+{
+    if (!p.is_pinned) {
+        p.acceleration += force;
+    }
+    // verlet integration
+    if (!p.is_pinned) {
+        Vector3f velocity = p.position - p.previous_position;
+        p.previous_position = p.position;
+        p.position += velocity + p.acceleration * (time_step * time_step);
+        p.acceleration = Vector3f(0, 0, 0); // reset after update
+    }
+}
+
+// 基线 Constraint::satisfy 的逐字副本：没有刚度和松弛系数，各类约束一律完全投影
+static void reference_satisfy(Constraint& c)
+{
+    if (!c.active)
+        return;
+
+    Vector3f delta = c.p2->position - c.p1->position;
+    float current_length = delta.length();
+    if (current_length == 0)
+        return;
+    float difference = (current_length - c.initial_length) / current_length;
+    Vector3f correction = delta * 0.5f * difference;
+
+    if (!c.p1->is_pinned)
+        c.p1->position += correction;
+    if (!c.p2->is_pinned)
+        c.p2->position -= correction;
+}
+
+// 基线 Cloth::update
+void reference_step(std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+    const Vector3f& force, float time_step, int iterations)
+{
+    for (auto& p : particles)
+        reference_update(p, force, time_step);
+    for (int i = 0; i < iterations; ++i) {
+        for (auto& c : constraints)
+            reference_satisfy(c);
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "constraint.h"
+#include "particle.h"
+#include "vector3f.h"
+#include <vector>
+
+// 冻结的参考实现：最初的标量 Cloth::update —— 逐粒子 Verlet 积分，
+// 再按数组顺序做固定次数的 Gauss-Seidel 距离约束投影。
+// 没有提前退出、加速、分批周期、附着约束或并行，回归测试以它为基准，
+// 优化现行求解器时不要改动这里。
+void reference_step(std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+    const Vector3f& force, float time_step, int iterations);
@@ -0,0 +1,232 @@
+#include "regression.h"
+#include "cloth_state.h"
+#include "grid_topology.h"
+#include "reference_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+// 一个场景的完整状态；参考与现行各建一份，互不共享粒子
+struct RegressionCase {
+    std::vector<Particle> particles;
+    std::vector<Constraint> constraints;
+    std::vector<float> rest_height; // 初始高度，用于势能
+    Vector3f force;
+    int rows = 0, cols = 0; // 规则网格的行列数，存档为 0
+    GridType type = GridType::Square;
+    int tear_frame = -1; // 在该帧开始前撕开 tear_particle
+    size_t tear_particle = 0;
+};
+
+// 竖直平面内的网格布，row 0 在最上方；与基线的拓扑一样只含结构约束
+void build_sheet(RegressionCase& rc, int rows, int cols, float spacing, GridType type = GridType::Square)
+{
+    rc.rows = rows;
+    rc.cols = cols;
+    rc.type = type;
+    // 基线没有剪切、弯曲约束，也没有刚度：参考实现把每条约束都完全投影，
+    // 只有刚度为 1 的结构约束两边的模型才相同
+    BendingOptions options;
+    options.shear = false;
+    options.bending = false;
+    options.dihedral = false;
+    GridPlacement placement;
+    placement.down = Vector3f(0, -1, 0);
+    std::vector<DihedralConstraint> unused;
+    build_grid(type, rows, cols, spacing, placement, rc.particles, rc.constraints, unused, options);
+}
+
+bool build_case(RegressionScenario scenario, const std::string& save_file, RegressionCase& rc)
+{
+    switch (scenario) {
+    case RegressionScenario::PinnedSheet:
+        build_sheet(rc, 30, 30, DEFAULT_REST_DISTANCE);
+        for (int c = 0; c < rc.cols; ++c)
+            rc.particles[c].is_pinned = true;
+        rc.force = Vector3f(0, -GRAVITY_CONST, 0);
+        break;
+    case RegressionScenario::WindFlag:
+        build_sheet(rc, 15, 25, 4.0f);
+        for (int r = 0; r < rc.rows; ++r)
+            rc.particles[r * rc.cols].is_pinned = true; // 旗杆
+        rc.force = Vector3f(50.0f, -GRAVITY_CONST, 0);
+        break;
+    case RegressionScenario::Tear:
+        build_sheet(rc, 30, 30, DEFAULT_REST_DISTANCE);
+        for (int c = 0; c < rc.cols; ++c)
+            rc.particles[c].is_pinned = true;
+        rc.force = Vector3f(0, -GRAVITY_CONST, 0);
+        rc.tear_frame = 60;
+        rc.tear_particle = static_cast<size_t>(rc.rows / 2) * rc.cols + rc.cols / 2;
+        break;
+    case RegressionScenario::Stocking:
+        if (!ClothState::load(rc.particles, rc.constraints, save_file) || rc.particles.empty())
+            return false;
+        rc.force = Vector3f(0, -GRAVITY_CONST, 0);
+        break;
+    case RegressionScenario::HexSheet:
+        build_sheet(rc, 30, 30, DEFAULT_REST_DISTANCE, GridType::Hexagon);
+        for (int c = 0; c < rc.cols; ++c)
+            rc.particles[c].is_pinned = true;
+        rc.force = Vector3f(0, -GRAVITY_CONST, 0);
+        break;
+    }
+    rc.rest_height.reserve(rc.particles.size());
+    for (const auto& p : rc.particles)
+        rc.rest_height.push_back(p.position.y);
+    return true;
+}
+
+// 删除与粒子相连的所有约束（与交互撕裂相同）
+void tear(RegressionCase& rc)
+{
+    const Particle* torn = &rc.particles[rc.tear_particle];
+    rc.constraints.erase(
+        std::remove_if(rc.constraints.begin(), rc.constraints.end(),
+            [torn](const Constraint& c) { return c.p1 == torn || c.p2 == torn; }),
+        rc.constraints.end());
+}
+
+// 结构约束的最大相对误差
+float structural_error(const std::vector<Constraint>& constraints)
+{
+    float max_error = 0.0f;
+    for (const auto& c : constraints) {
+        if (!c.active || c.type != ConstraintType::Structural)
+            continue;
+        float length = (c.p2->position - c.p1->position).length();
+        max_error = std::max(max_error, std::abs(length - c.initial_length) / c.initial_length);
+    }
+    return max_error;
+}
+
+// 单位质量的动能 + 相对初始高度的重力势能
+double energy(const RegressionCase& rc, float time_step)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < rc.particles.size(); ++i) {
+        const Particle& p = rc.particles[i];
+        if (p.is_pinned)
+            continue;
+        Vector3f v = (p.position - p.previous_position) * (1.0f / time_step);
+        sum += 0.5 * v.dot(v) - rc.force.y * (p.position.y - rc.rest_height[i]);
+    }
+    return sum;
+}
+
+float position_rms(const RegressionCase& a, const RegressionCase& b)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < a.particles.size(); ++i) {
+        Vector3f d = a.particles[i].position - b.particles[i].position;
+        sum += d.dot(d);
+    }
+    return a.particles.empty() ? 0.0f : static_cast<float>(std::sqrt(sum / a.particles.size()));
+}
+
+}
+
+const char* regression_scenario_name(RegressionScenario scenario)
+{
+    switch (scenario) {
+    case RegressionScenario::PinnedSheet:
+        return "pinned_sheet";
+    case RegressionScenario::WindFlag:
+        return "wind_flag";
+    case RegressionScenario::Tear:
+        return "tear";
+    case RegressionScenario::Stocking:
+        return "stocking";
+    default:
+        return "hex_sheet";
+    }
+}
+
+bool run_regression(RegressionScenario scenario, const SolverSettings& live_settings, RegressionMode mode,
+    int frames, const RegressionTolerances& tolerances, const std::string& save_file, RegressionResult& result)
+{
+    RegressionCase ref, live;
+    if (!build_case(scenario, save_file, ref) || !build_case(scenario, save_file, live))
+        return false;
+
+    ConstraintSolver solver;
+    solver.settings = live_settings;
+    solver.set_grid(live.rows, live.cols, live.type);
+
+    result = RegressionResult();
+    result.scenario = scenario;
+    result.frames.reserve(frames);
+    for (int f = 0; f < frames; ++f) {
+        if (f == ref.tear_frame) {
+            tear(ref);
+            tear(live);
+            solver.invalidate_tethers();
+        }
+
+        reference_step(ref.particles, ref.constraints, ref.force, TIME_STEP, live_settings.max_iterations);
+
+        for (auto& p : live.particles) {
+            p.apply_force(live.force);
+            p.update(TIME_STEP);
+        }
+        solver.solve(live.particles, live.constraints);
+
+        RegressionFrame rf;
+        rf.frame = f;
+        rf.position_rms = position_rms(live, ref);
+        rf.reference_error = structural_error(ref.constraints);
+        rf.live_error = structural_error(live.constraints);
+        double ref_energy = energy(ref, TIME_STEP);
+        double live_energy = energy(live, TIME_STEP);
+        rf.reference_energy = static_cast<float>(ref_energy);
+        rf.live_energy = static_cast<float>(live_energy);
+        rf.energy_drift = static_cast<float>(std::abs(live_energy - ref_energy) / std::max(std::abs(ref_energy), 1.0));
+        result.frames.push_back(rf);
+
+        float excess = rf.live_error - rf.reference_error;
+        result.max_position_rms = std::max(result.max_position_rms, rf.position_rms);
+        result.max_error_excess = std::max(result.max_error_excess, excess);
+        result.max_energy_drift = std::max(result.max_energy_drift, rf.energy_drift);
+        result.final_error_excess = excess;
+        // NaN 也算失败
+        bool within = rf.position_rms <= tolerances.position_rms && excess <= tolerances.constraint_error
+            && rf.energy_drift <= tolerances.energy_drift;
+        if (mode == RegressionMode::PerFrame && !within && result.first_failure < 0)
+            result.first_failure = f;
+    }
+
+    // 能量以参考整段运行中的最大绝对值为尺度，超出 energy_bound 倍（或出现 NaN）的第一帧即失败；
+    // 末帧结构误差超标记在最后一帧
+    float energy_scale = 1.0f;
+    for (const auto& rf : result.frames)
+        energy_scale = std::max(energy_scale, std::abs(rf.reference_energy));
+    for (const auto& rf : result.frames) {
+        float ratio = std::abs(rf.live_energy) / energy_scale;
+        if (!(ratio <= result.energy_ratio) && !std::isnan(result.energy_ratio))
+            result.energy_ratio = ratio;
+        if (mode == RegressionMode::Shipped && !(ratio <= tolerances.energy_bound) && result.first_failure < 0)
+            result.first_failure = rf.frame;
+    }
+    if (mode == RegressionMode::Shipped && !(result.final_error_excess <= tolerances.final_error)
+        && result.first_failure < 0)
+        result.first_failure = frames - 1;
+    return true;
+}
+
+bool write_regression_csv(const std::vector<RegressionResult>& results, const std::string& filename)
+{
+    std::ofstream ofs(filename);
+    if (!ofs)
+        return false;
+    ofs << "scenario,frame,position_rms,reference_error,live_error,reference_energy,live_energy,energy_drift\n";
+    for (const auto& r : results) {
+        for (const auto& f : r.frames) {
+            ofs << regression_scenario_name(r.scenario) << "," << f.frame << "," << f.position_rms << ","
+                << f.reference_error << "," << f.live_error << "," << f.reference_energy << "," << f.live_energy
+                << "," << f.energy_drift << "\n";
+        }
+    }
+    return true;
+}
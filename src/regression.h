@@ -0,0 +1,66 @@
+#pragma once
+#include "solver.h"
+#include <string>
+#include <vector>
+
+// 回归场景
+enum class RegressionScenario {
+    PinnedSheet, // 顶边固定的方格布自然下垂
+    WindFlag, // 一侧固定的旗帜在风中
+    Tear, // 下垂过程中撕开中间一个粒子
+    Stocking, // 从存档（cloth_save.txt）加载的丝袜
+    HexSheet // 顶边固定的六边形网格布自然下垂
+};
+constexpr int REGRESSION_SCENARIO_COUNT = 5;
+
+const char* regression_scenario_name(RegressionScenario scenario);
+
+// 对照方式：等价设置下两边的轨迹应在容差内逐帧重合；发行设置（提前结束、附着约束、
+// 多重网格等）走的是另一条轨迹，只能检查应当成立的整体指标
+enum class RegressionMode {
+    PerFrame, // 逐帧对照位置、结构误差和能量
+    Shipped // 末帧结构误差不比参考差，能量有界
+};
+
+// 对照的容差，超出即判为失败
+struct RegressionTolerances {
+    // PerFrame：任一帧超出即失败
+    float position_rms = REGRESSION_POSITION_TOL; // 位置偏差的均方根
+    float constraint_error = REGRESSION_ERROR_TOL; // 现行求解器的结构误差比参考多出的部分
+    float energy_drift = REGRESSION_ENERGY_TOL; // 能量的相对偏差
+    // Shipped
+    float final_error = REGRESSION_FINAL_ERROR_TOL; // 末帧结构误差比参考多出的部分
+    float energy_bound = REGRESSION_ENERGY_BOUND; // max|E_live| / max(max|E_ref|, 1) 的上限
+};
+
+// 一帧的对照结果
+struct RegressionFrame {
+    int frame;
+    float position_rms; // 现行与参考位置之差的均方根
+    float reference_error; // 参考实现的结构约束最大相对误差
+    float live_error; // 现行求解器的结构约束最大相对误差
+    float reference_energy; // 参考实现的单位质量动能 + 重力势能
+    float live_energy; // 现行求解器的单位质量动能 + 重力势能
+    float energy_drift; // |E_live - E_ref| / max(|E_ref|, 1)
+};
+
+struct RegressionResult {
+    RegressionScenario scenario;
+    std::vector<RegressionFrame> frames;
+    float max_position_rms = 0.0f;
+    float max_error_excess = 0.0f;
+    float max_energy_drift = 0.0f;
+    float final_error_excess = 0.0f; // 末帧现行结构误差比参考多出的部分
+    float energy_ratio = 0.0f; // max|E_live| / max(max|E_ref|, 1)
+    int first_failure = -1; // 第一个超出容差的帧，-1 表示全部通过
+
+    bool passed() const { return first_failure < 0; }
+};
+
+// 同一初始状态分别交给冻结的参考实现（reference_step）和现行求解器（ConstraintSolver）
+// 推进 frames 帧，按 mode 对照；参考实现的迭代次数取 live_settings.max_iterations。
+// 存档场景读取 save_file，读取失败时返回 false
+bool run_regression(RegressionScenario scenario, const SolverSettings& live_settings, RegressionMode mode,
+    int frames, const RegressionTolerances& tolerances, const std::string& save_file, RegressionResult& result);
+
+bool write_regression_csv(const std::vector<RegressionResult>& results, const std::string& filename);
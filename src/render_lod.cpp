@@ -0,0 +1,93 @@
+#include "render_lod.h"
+#include "constants.h"
+#include <algorithm>
+
+namespace {
+// 0, stride, 2 * stride, ...，最后一行（列）总在其中，保证边缘不丢
+void sample_axis(int count, int stride, std::vector<int>& out)
+{
+    out.clear();
+    for (int i = 0; i < count; i += stride)
+        out.push_back(i);
+    if (count > 0 && out.back() != count - 1)
+        out.push_back(count - 1);
+}
+
+bool same_grid(const RenderGrid& a, const RenderGrid& b)
+{
+    return a.first == b.first && a.rows == b.rows && a.cols == b.cols && a.spacing == b.spacing && a.type == b.type && a.closed == b.closed;
+}
+}
+
+bool RenderLod::update(std::span<const Vector3f> positions, std::span<const RenderGrid> grids, const ViewFrustum& frustum)
+{
+    std::vector<int> wanted(grids.size(), 1);
+    bool coarse = false;
+    for (size_t g = 0; g < grids.size(); ++g) {
+        const RenderGrid& grid = grids[g];
+        if (grid.rows <= 0 || grid.cols <= 0 || grid.first + static_cast<size_t>(grid.rows) * grid.cols > positions.size())
+            return false; // 网格与粒子数组对不上（例如刚导入的网格），画完整拓扑
+
+        // 取四角和中心离相机最近的深度，估计网格在屏幕上最大的边长
+        const int r1 = grid.rows - 1, c1 = grid.cols - 1;
+        const int probes[5][2] = { { 0, 0 }, { 0, c1 }, { r1, 0 }, { r1, c1 }, { r1 / 2, c1 / 2 } };
+        float depth = 0.0f;
+        bool first = true;
+        for (const auto& rc : probes) {
+            float z = frustum.to_camera(positions[grid.first + static_cast<size_t>(rc[0]) * grid.cols + rc[1]]).z;
+            depth = first ? z : std::min(depth, z);
+            first = false;
+        }
+        const int max_stride = std::max(grid.rows, grid.cols) - 1;
+        int stride = 1;
+        if (depth <= CAMERA_NEAR) {
+            // 整块在近平面附近或后方时不降低细节
+        } else {
+            const float edge_pixels = grid.spacing * frustum.focal / depth;
+            while (stride * 2 <= max_stride && edge_pixels * stride < LOD_MIN_EDGE_PIXELS)
+                stride *= 2;
+        }
+        wanted[g] = stride;
+        coarse = coarse || stride > 1;
+    }
+    if (!coarse)
+        return false;
+
+    const bool same = cached_grids.size() == grids.size()
+        && std::equal(grids.begin(), grids.end(), cached_grids.begin(), same_grid)
+        && wanted == strides;
+    if (!same) {
+        cached_grids.assign(grids.begin(), grids.end());
+        strides = std::move(wanted);
+        rebuild();
+    }
+    return true;
+}
+
+void RenderLod::rebuild()
+{
+    point_indices.clear();
+    coarse_lines.clear();
+    std::vector<int> rows, cols;
+    for (size_t g = 0; g < cached_grids.size(); ++g) {
+        const RenderGrid& grid = cached_grids[g];
+        sample_axis(grid.rows, strides[g], rows);
+        sample_axis(grid.cols, strides[g], cols);
+        auto index = [&](int r, int c) { return static_cast<uint32_t>(grid.first + static_cast<size_t>(r) * grid.cols + c); };
+        // 粗线的静止长度取两端格点静止位置之差；闭合网格的接缝把第 0 列看作第 cols 列
+        auto rest = [&](int r1, int c1, int r2, int c2) {
+            return (grid_rest_position(grid.type, r2, c2, grid.spacing) - grid_rest_position(grid.type, r1, c1, grid.spacing)).length();
+        };
+        for (size_t i = 0; i < rows.size(); ++i) {
+            for (size_t j = 0; j < cols.size(); ++j) {
+                point_indices.push_back(index(rows[i], cols[j]));
+                if (j + 1 < cols.size())
+                    coarse_lines.push_back({ index(rows[i], cols[j]), index(rows[i], cols[j + 1]), rest(rows[i], cols[j], rows[i], cols[j + 1]), 0.0f });
+                else if (grid.closed && cols.size() > 2)
+                    coarse_lines.push_back({ index(rows[i], cols[j]), index(rows[i], 0), rest(rows[i], cols[j], rows[i], grid.cols), 0.0f });
+                if (i + 1 < rows.size())
+                    coarse_lines.push_back({ index(rows[i], cols[j]), index(rows[i + 1], cols[j]), rest(rows[i], cols[j], rows[i + 1], cols[j]), 0.0f });
+            }
+        }
+    }
+}
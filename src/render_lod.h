@@ -0,0 +1,29 @@
+#pragma once
+#include "frustum.h"
+#include "render_snapshot.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 渲染细节层次：按网格在屏幕上的边长为每块网格选一个显示步长（2 的幂），
+// 只画步长格点上的粒子和连接相邻格点的粗线。物理仍在完整分辨率上计算，
+// 粗网格的下标只在网格或步长变化时重建
+class RenderLod {
+public:
+    // 根据当前视锥更新各网格的步长。所有网格的步长都是 1 时返回 false，
+    // 调用方应直接画完整拓扑
+    bool update(std::span<const Vector3f> positions, std::span<const RenderGrid> grids, const ViewFrustum& frustum);
+
+    // 要画的粒子下标与粗线，只在 update 返回 true 后有效。
+    // 粗线跨过多条约束，没有求解器给出的应变（strain 为 0），画时按当前长度计算
+    std::span<const uint32_t> points() const { return point_indices; }
+    std::span<const RenderSnapshot::Line> lines() const { return coarse_lines; }
+
+private:
+    std::vector<RenderGrid> cached_grids;
+    std::vector<int> strides; // 与 cached_grids 一一对应
+    std::vector<uint32_t> point_indices;
+    std::vector<RenderSnapshot::Line> coarse_lines;
+
+    void rebuild();
+};
@@ -0,0 +1,30 @@
+#include "render_snapshot.h"
+#include "parallel.h"
+#include <cmath>
+
+namespace {
+const size_t MIN_CHUNK = 4096;
+}
+
+void RenderSnapshot::capture(std::span<const Particle> particles, std::span<const Constraint> constraints,
+    std::span<const float> strain)
+{
+    positions.resize(particles.size());
+    pinned.resize(particles.size());
+    parallel_for(particles.size(), MIN_CHUNK, [&](size_t i) {
+        positions[i] = particles[i].position;
+        pinned[i] = particles[i].is_pinned;
+    });
+
+    const Particle* base = particles.data();
+    const bool solved = strain.size() == constraints.size();
+    lines.clear();
+    for (size_t i = 0; i < constraints.size(); ++i) {
+        const Constraint& c = constraints[i];
+        if (!c.active || c.type == ConstraintType::Bending)
+            continue;
+        float e = solved ? strain[i] : std::abs((c.p1->position - c.p2->position).length() - c.initial_length) / c.initial_length;
+        lines.push_back({ static_cast<uint32_t>(c.p1 - base), static_cast<uint32_t>(c.p2 - base), c.initial_length, e });
+    }
+    constraint_count = constraints.size();
+}
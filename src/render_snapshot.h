@@ -0,0 +1,37 @@
+#pragma once
+#include "constraint.h"
+#include "grid_topology.h"
+#include "particle.h"
+#include "vector3f.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 渲染用的一帧快照。物理步在后台推进下一帧时，投影和顶点生成只读这份数据，
+// 不碰正在被修改的粒子和约束
+struct RenderSnapshot {
+    // 一条要画的约束线
+    struct Line {
+        uint32_t a, b; // 粒子下标
+        float rest_length;
+        float strain; // 相对应变 |L - L0| / L0，着色用
+    };
+
+    std::vector<Vector3f> positions;
+    std::vector<uint8_t> pinned;
+    std::vector<Line> lines; // 有效且不是隔点弯曲的约束（隔点弯曲与结构边重叠）
+    size_t constraint_count = 0; // 快照时的约束总数
+
+    // strain 为求解器在这一步写出的应变（与 constraints 等长）；为空时按当前位置现算
+    void capture(std::span<const Particle> particles, std::span<const Constraint> constraints,
+        std::span<const float> strain = {});
+};
+
+// 粒子数组中一块行优先排列的规则网格，供 LOD 和表面渲染使用
+struct RenderGrid {
+    size_t first; // 第一个粒子的下标
+    int rows, cols;
+    float spacing; // 相邻粒子的静止间距
+    GridType type = GridType::Square;
+    bool closed = false; // 每行首尾相接（圆筒）
+};
@@ -3,7 +3,10 @@
 #include <iostream>    // For font loading error
 
 Renderer::Renderer(sf::RenderWindow &window)
-    : window_(window), font_loaded_(false) {
+    : window_(window), font_loaded_(false),
+      stats_hud_(font_, 30, sf::Color::White),
+      help_hud_(font_, 22, sf::Color(200, 200, 200)),
+      info_hud_(font_, 18, sf::Color::Yellow) {
     font_loaded_ = loadFont();
 }
 
@@ -182,56 +185,52 @@ void Renderer::drawStatsPanel(const SimulationManager &sim_manager, float fps,
                               bool tear_mode, bool wind_on,
                               float current_win_width) {
     if (!font_loaded_) return;
-    std::stringstream ss;
-    ss.precision(1);
-    ss << std::fixed;
-    ss << "Points: " << sim_manager.getParticles().size()
-       << "\nConstraints: " << sim_manager.getConstraints().size()
-       << "\nFPS: " << fps << "\nTear Mode: " << (tear_mode ? "ON" : "OFF")
-       << "\nWind Mode: " << (wind_on ? "ON" : "OFF");
-    ss << "\nGrid: ";
-    GridType grid_type = sim_manager.getGridType();
-    if (grid_type == GridType::Square)
-        ss << "Square";
-    else if (grid_type == GridType::Triangle)
-        ss << "Triangle";
-    else if (grid_type == GridType::Hexagon)
-        ss << "Hexagon";
-
-    sf::Text info_text(ss.str(), font_);
-    info_text.setFillColor(sf::Color::White);
-    info_text.setPosition(
-        sf::Vector2f(static_cast<float>(current_win_width - 350), 20.f));
-    window_.draw(info_text);
+    stats_hud_.set_line(0, line_.clear() << "Points: "
+                                         << sim_manager.getParticles().size());
+    stats_hud_.set_line(1, line_.clear()
+                               << "Constraints: "
+                               << sim_manager.getConstraints().size());
+    if (stats_refresh_.due())
+        stats_hud_.set_line(2, line_.clear() << "FPS: " << HudFixed{fps, 1});
+    stats_hud_.set_line(3, line_.clear() << "Tear Mode: "
+                                         << (tear_mode ? "ON" : "OFF"));
+    stats_hud_.set_line(4, line_.clear() << "Wind Mode: "
+                                         << (wind_on ? "ON" : "OFF"));
+    stats_hud_.set_line(5, line_.clear()
+                               << "Grid: "
+                               << grid_type_name(sim_manager.getGridType()));
+    stats_hud_.draw(window_, sf::Vector2f(
+                                 static_cast<float>(current_win_width - 350),
+                                 20.f));
 }
 
 void Renderer::drawHelpPanel(float current_win_width,
                              float current_win_height) {
     if (!font_loaded_) return;
-    std::string help_str = "Left click: Drag particle\n"
-                           "Right click: Pin/unpin\n"
-                           "Middle click: Pan (Disabled)\n"
-                           "Mouse wheel: Zoom\n"
-                           "R: Reset cloth\n"
-                           "+/-: Gravity\n"
-                           "[/]: Wind Strength\n"
-                           "WASD: Rotate view\n"
-                           "Space: Toggle wind\n"
-                           "T: Triangle grid\n"
-                           "H: Hex grid\n"
-                           "Q: Square grid\n"
-                           "Ctrl+S: Save cloth\n"
-                           "Ctrl+L: Load cloth\n"
-                           "I: Toggle Info";
-
-    sf::Text help_text(help_str, font_);
-    help_text.setFillColor(sf::Color(200, 200, 200));
-    help_text.setCharacterSize(22);
-    auto help_bounds = help_text.getLocalBounds();
-    help_text.setPosition(
-        sf::Vector2f(current_win_width - help_bounds.width - 40.f,
-                     current_win_height - help_bounds.height - 80.f));
-    window_.draw(help_text);
+    // The help text never changes, so it is laid out once.
+    if (help_hud_.line_count() == 0) {
+        const char *help_lines[] = {"Left click: Drag particle",
+                                    "Right click: Pin/unpin",
+                                    "Middle click: Pan (Disabled)",
+                                    "Mouse wheel: Zoom",
+                                    "R: Reset cloth",
+                                    "+/-: Gravity",
+                                    "[/]: Wind Strength",
+                                    "WASD: Rotate view",
+                                    "Space: Toggle wind",
+                                    "T: Triangle grid",
+                                    "H: Hex grid",
+                                    "Q: Square grid",
+                                    "Ctrl+S: Save cloth",
+                                    "Ctrl+L: Load cloth",
+                                    "I: Toggle Info"};
+        for (size_t i = 0; i < std::size(help_lines); ++i)
+            help_hud_.set_line(i, help_lines[i]);
+    }
+    help_hud_.draw(window_,
+                   sf::Vector2f(current_win_width - help_hud_.width() - 40.f,
+                                current_win_height - help_hud_.height() -
+                                    80.f));
 }
 
 void Renderer::drawThickLine(const sf::Vector2f &from, const sf::Vector2f &to,
@@ -333,37 +332,25 @@ void Renderer::drawDynamicInfoPanel(const Camera &camera,
                                     float current_win_height) {
     if (!font_loaded_ || !display_info) return;
 
-    std::stringstream ss;
-    ss.precision(1);
-    ss << std::fixed;
-    ss << "Cam Pos: (" << camera.getPosition().x << ", "
-       << camera.getPosition().y << ", " << camera.getPosition().z << ")\n"
-       << "Cam Yaw: " << camera.getYaw() << "\n"
-       << "Cam Pitch: " << camera.getPitch() << "\n"
-       << "Grid: ";
-    GridType grid_type = sim_manager.getGridType();
-    if (grid_type == GridType::Square)
-        ss << "Square";
-    else if (grid_type == GridType::Triangle)
-        ss << "Triangle";
-    else if (grid_type == GridType::Hexagon)
-        ss << "Hexagon";
-    ss << "\nParticles: " << sim_manager.getParticles().size();
-    ss << "\nConstraints: " << sim_manager.getConstraints().size();
-
-    std::string dynamic_info_str = ss.str();
-    sf::Text bottom_left_info(dynamic_info_str, font_);
-    bottom_left_info.setFillColor(sf::Color::Yellow);
-    bottom_left_info.setCharacterSize(18);
-
-    int line_count = 1;
-    for (char ch : dynamic_info_str) {
-        if (ch == '\n') line_count++;
+    if (info_refresh_.due() || info_hud_.line_count() == 0) {
+        const auto &pos = camera.getPosition();
+        info_hud_.set_line(0, line_.clear() << "Cam Pos: (" << HudFixed{pos.x, 1}
+                                            << ", " << HudFixed{pos.y, 1} << ", "
+                                            << HudFixed{pos.z, 1} << ")");
+        info_hud_.set_line(1, line_.clear()
+                                  << "Cam Yaw: " << HudFixed{camera.getYaw(), 1});
+        info_hud_.set_line(2, line_.clear() << "Cam Pitch: "
+                                            << HudFixed{camera.getPitch(), 1});
+        info_hud_.set_line(3, line_.clear()
+                                  << "Grid: "
+                                  << grid_type_name(sim_manager.getGridType()));
+        info_hud_.set_line(4, line_.clear() << "Particles: "
+                                            << sim_manager.getParticles().size());
+        info_hud_.set_line(5, line_.clear()
+                                  << "Constraints: "
+                                  << sim_manager.getConstraints().size());
     }
-    float text_height =
-        line_count * bottom_left_info.getCharacterSize() * 1.15f;
-
-    bottom_left_info.setPosition(
-        sf::Vector2f(20.f, current_win_height - text_height - 20.f));
-    window_.draw(bottom_left_info);
-}
\ No newline at end of file
+    info_hud_.draw(window_,
+                   sf::Vector2f(20.f, current_win_height - info_hud_.height() -
+                                          20.f));
+}
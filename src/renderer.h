@@ -4,8 +4,8 @@
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <vector>
-#include <sstream> // For string stream in UI text
 #include "camera.h"
+#include "hud.h"                // Cached HUD text panels
 #include "simulation_manager.h" // For particle, constraint, grid_type data
 #include "particle.h"           // For Particle data
 #include "constraint.h"         // For Constraint data
@@ -43,6 +43,16 @@ class Renderer {
     sf::Font font_;
     bool font_loaded_;
 
+    // HUD panels keep their sf::Text objects across frames; only lines whose
+    // text changed are re-laid out, and numeric fields refresh at
+    // HUD_REFRESH_HZ.
+    HudPanel stats_hud_;
+    HudPanel help_hud_;
+    HudPanel info_hud_;
+    HudRefresh stats_refresh_;
+    HudRefresh info_refresh_;
+    HudLine line_;
+
     void drawThickLine(const sf::Vector2f &from, const sf::Vector2f &to,
                        sf::Color color, float thickness);
     std::vector<std::string> getFontPaths() const;
@@ -0,0 +1,191 @@
+#include "scene.h"
+#include "grid_topology.h"
+#include "particle_rebind.h"
+#include "task_scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 在竖直平面内生成方格布料，row 0 在最上方；固定点由调用方设置
+void build_sheet(std::vector<Particle>& ps, std::vector<Constraint>& cs, std::vector<DihedralConstraint>& ds,
+    const Vector3f& origin, const Vector3f& right, int rows, int cols, float spacing)
+{
+    GridPlacement placement;
+    placement.origin = origin;
+    placement.right = right.normalized();
+    placement.down = Vector3f(0, -1, 0);
+    build_grid(GridType::Square, rows, cols, spacing, placement, ps, cs, ds);
+}
+}
+
+size_t Scene::append(ClothShape shape, std::vector<Particle>& local_particles, std::vector<Constraint>& local_constraints,
+    std::vector<DihedralConstraint>& local_dihedrals, int grid_rows, int grid_cols, float spacing, bool flat)
+{
+    ClothInstance inst { shape, particles.size(), local_particles.size(), constraints.size(), local_constraints.size(),
+        dihedrals.size(), local_dihedrals.size(), grid_rows, grid_cols, spacing };
+
+    // 插入可能扩容并释放旧数组，旧地址先记成整数
+    const auto old_base = reinterpret_cast<std::uintptr_t>(particles.data());
+    const size_t old_count = particles.size();
+    particles.insert(particles.end(), local_particles.begin(), local_particles.end());
+    if (reinterpret_cast<std::uintptr_t>(particles.data()) != old_base) {
+        rebind_particles(constraints, old_base, old_count, particles.data());
+        rebind_particles(dihedrals, old_base, old_count, particles.data());
+    }
+    Particle* base = particles.data() + inst.first_particle;
+    rebind_particles(local_constraints, local_particles.data(), local_particles.size(), base);
+    rebind_particles(local_dihedrals, local_particles.data(), local_particles.size(), base);
+    constraints.insert(constraints.end(), local_constraints.begin(), local_constraints.end());
+    dihedrals.insert(dihedrals.end(), local_dihedrals.begin(), local_dihedrals.end());
+    strain.clear();
+
+    instances.push_back(inst);
+    solvers.emplace_back();
+    if (flat)
+        solvers.back().set_grid(grid_rows, grid_cols);
+    instance_stats.emplace_back();
+    return instances.size() - 1;
+}
+
+size_t Scene::add_flag(const Vector3f& origin, const Vector3f& right, int rows, int cols, float spacing)
+{
+    std::vector<Particle> ps;
+    std::vector<Constraint> cs;
+    std::vector<DihedralConstraint> ds;
+    build_sheet(ps, cs, ds, origin, right, rows, cols, spacing);
+    for (int r = 0; r < rows; ++r)
+        ps[r * cols].is_pinned = true; // 旗杆
+    return append(ClothShape::Flag, ps, cs, ds, rows, cols, spacing);
+}
+
+size_t Scene::add_curtain(const Vector3f& origin, const Vector3f& right, int rows, int cols, float spacing, int ring_spacing)
+{
+    std::vector<Particle> ps;
+    std::vector<Constraint> cs;
+    std::vector<DihedralConstraint> ds;
+    build_sheet(ps, cs, ds, origin, right, rows, cols, spacing);
+    for (int c = 0; c < cols; ++c)
+        ps[c].is_pinned = c % std::max(ring_spacing, 1) == 0 || c == cols - 1; // 挂环
+    return append(ClothShape::Curtain, ps, cs, ds, rows, cols, spacing);
+}
+
+size_t Scene::add_stocking(const Vector3f& origin, int rings, int segments, float height, float radius)
+{
+    const float taper_rings = rings * 0.25f; // 底部四分之一收窄
+    auto ring_radius = [&](int v) {
+        return v < taper_rings ? radius * (v / taper_rings) : radius;
+    };
+
+    std::vector<Particle> ps;
+    std::vector<Constraint> cs;
+    std::vector<DihedralConstraint> ds;
+    ps.reserve(static_cast<size_t>(rings) * segments);
+    for (int v = 0; v < rings; ++v) {
+        float y = origin.y + v * height / (rings - 1);
+        float r = ring_radius(v);
+        for (int h = 0; h < segments; ++h) {
+            float theta = h * 2.0f * static_cast<float>(M_PI) / segments;
+            ps.emplace_back(origin.x + r * std::cos(theta), y, origin.z + r * std::sin(theta), v == rings - 1);
+        }
+    }
+    auto at = [&](int v, int h) { return &ps[v * segments + (h % segments)]; };
+    for (int v = 0; v < rings; ++v) {
+        for (int h = 0; h < segments; ++h) {
+            if (v < rings - 1)
+                cs.emplace_back(at(v, h), at(v + 1, h));
+            // 半径接近 0 的圈不加环向约束
+            if (ring_radius(v) >= 1.0f)
+                cs.emplace_back(at(v, h), at(v, h + 1));
+            if (v < rings - 1 && ring_radius(v) >= 1.0f) {
+                cs.emplace_back(at(v, h), at(v + 1, h + 1));
+                cs.back().type = ConstraintType::Shear;
+                cs.back().stiffness = SHEAR_STIFFNESS;
+            }
+            if (v < rings - 2) {
+                cs.emplace_back(at(v, h), at(v + 2, h));
+                cs.back().type = ConstraintType::Bending;
+                cs.back().stiffness = BENDING_STIFFNESS;
+            }
+        }
+    }
+    std::stable_sort(cs.begin(), cs.end(), [](const Constraint& a, const Constraint& b) { return a.type < b.type; });
+    return append(ClothShape::Stocking, ps, cs, ds, rings, segments, height / (rings - 1), false);
+}
+
+void Scene::build_stadium(int flag_count)
+{
+    clear();
+    const int flag_rows = 12, flag_cols = 20;
+    const float spacing = 4.0f;
+    const float ring = std::max(300.0f, flag_count * flag_cols * spacing / 5.0f);
+    for (int i = 0; i < flag_count; ++i) {
+        float a = i * 2.0f * static_cast<float>(M_PI) / flag_count;
+        Vector3f pole(ring * std::cos(a), 200.0f, ring * std::sin(a));
+        Vector3f tangent(-std::sin(a), 0, std::cos(a));
+        add_flag(pole, tangent, flag_rows, flag_cols, spacing);
+    }
+    add_curtain(Vector3f(-150, 300, -60), Vector3f(1, 0, 0), 40, 30, spacing);
+    add_curtain(Vector3f(30, 300, 60), Vector3f(1, 0, 0), 40, 30, spacing);
+    add_stocking(Vector3f(0, -50, 0), 25, 15, 300.0f, 40.0f);
+}
+
+void Scene::clear()
+{
+    particles.clear();
+    constraints.clear();
+    dihedrals.clear();
+    strain.clear();
+    instances.clear();
+    solvers.clear();
+    instance_stats.clear();
+    last_stats = SolverStats();
+}
+
+void Scene::step(float gravity, float wind, float time_step)
+{
+    // 实例之间没有共享粒子，每个实例一个任务，大小不一的实例由工作窃取自动均衡；
+    // 汇总统计的节点依赖所有实例
+    strain.resize(constraints.size());
+    TaskGraph graph;
+    std::vector<TaskGraph::Node> solved;
+    solved.reserve(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+        solved.push_back(graph.add([this, i, gravity, wind, time_step] { step_instance(i, gravity, wind, time_step); }));
+    graph.add([this] { aggregate_stats(); }, solved);
+    TaskScheduler::instance().run(graph);
+}
+
+void Scene::step_instance(size_t i, float gravity, float wind, float time_step)
+{
+    const ClothInstance& inst = instances[i];
+    std::span<Particle> ps(particles.data() + inst.first_particle, inst.particle_count);
+    std::span<Constraint> cs(constraints.data() + inst.first_constraint, inst.constraint_count);
+    std::span<DihedralConstraint> ds(dihedrals.data() + inst.first_dihedral, inst.dihedral_count);
+    std::span<float> es(strain.data() + inst.first_constraint, inst.constraint_count);
+    for (auto& p : ps) {
+        p.apply_force(Vector3f(wind, -gravity, 0));
+        p.update(time_step);
+    }
+    solvers[i].settings = settings;
+    instance_stats[i] = solvers[i].solve(ps, cs, ds, es);
+}
+
+void Scene::aggregate_stats()
+{
+    SolverStats total;
+    float sum_sq = 0.0f;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const SolverStats& s = instance_stats[i];
+        total.iterations = std::max(total.iterations, s.iterations);
+        total.max_error = std::max(total.max_error, s.max_error);
+        total.multigrid_levels = std::max(total.multigrid_levels, s.multigrid_levels);
+        total.tethers += s.tethers;
+        sum_sq += s.rms_error * s.rms_error * instances[i].constraint_count;
+        for (int t = 0; t < CONSTRAINT_TYPE_COUNT; ++t) {
+            total.batch_sweeps[t] = std::max(total.batch_sweeps[t], s.batch_sweeps[t]);
+            total.batch_ms[t] += s.batch_ms[t];
+        }
+    }
+    total.rms_error = constraints.empty() ? 0.0f : std::sqrt(sum_sq / constraints.size());
+    last_stats = total;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "constraint.h"
+#include "dihedral_constraint.h"
+#include "particle.h"
+#include "solver.h"
+#include "vector3f.h"
+#include <span>
+#include <vector>
+
+// 场景中的布料形状
+enum class ClothShape { Flag,
+    Curtain,
+    Stocking };
+
+// 一块布料在场景共享数组中占据的区间
+struct ClothInstance {
+    ClothShape shape;
+    size_t first_particle, particle_count;
+    size_t first_constraint, constraint_count;
+    size_t first_dihedral, dihedral_count;
+    // 粒子按 rows x cols 行优先排列（丝袜为 圈数 x 每圈段数），spacing 为相邻粒子的静止间距
+    int rows = 0, cols = 0;
+    float spacing = 0.0f;
+};
+
+// 多块布料的场景：所有实例的粒子、约束存放在同一组数组中，
+// 每个实例的约束只引用本实例的粒子，因此各实例可以并行求解
+class Scene {
+public:
+    SolverSettings settings; // 所有实例共用的求解参数
+
+    // 旗帜：rows x cols 的竖直方格，沿 right 方向展开，靠旗杆的一列固定
+    size_t add_flag(const Vector3f& origin, const Vector3f& right, int rows, int cols, float spacing);
+    // 窗帘：顶行每隔 ring_spacing 个粒子固定一个挂环
+    size_t add_curtain(const Vector3f& origin, const Vector3f& right, int rows, int cols, float spacing, int ring_spacing = 4);
+    // 丝袜：与 gen.py 相同的圆筒，底部四分之一逐渐收窄，顶圈固定
+    size_t add_stocking(const Vector3f& origin, int rings, int segments, float height, float radius);
+
+    // 体育场：flag_count 面旗帜围成一圈，中间挂两幅窗帘和一只丝袜
+    void build_stadium(int flag_count);
+    void clear();
+
+    // 推进一帧：按实例并行积分并求解约束
+    void step(float gravity, float wind, float time_step);
+
+    const std::vector<Particle>& get_particles() const { return particles; }
+    const std::vector<Constraint>& get_constraints() const { return constraints; }
+    const std::vector<ClothInstance>& get_instances() const { return instances; }
+    // 上一步求解器写出的每条约束的相对应变；布料增删后、下一步之前为空
+    std::span<const float> get_strain() const { return strain; }
+    // 所有实例的汇总统计：迭代数与误差取最大，耗时与附着约束数累加
+    const SolverStats& get_last_stats() const { return last_stats; }
+
+private:
+    std::vector<Particle> particles;
+    std::vector<Constraint> constraints;
+    std::vector<DihedralConstraint> dihedrals;
+    std::vector<float> strain; // 与 constraints 一一对应
+    std::vector<ClothInstance> instances;
+    std::vector<ConstraintSolver> solvers; // 每个实例一份，保存各自的缓存（附着约束、谱半径、粗层）
+    std::vector<SolverStats> instance_stats;
+    SolverStats last_stats;
+
+    // 推进一个实例：积分后求解本实例的约束
+    void step_instance(size_t i, float gravity, float wind, float time_step);
+    // 所有实例的统计汇总到 last_stats
+    void aggregate_stats();
+
+    // 把局部生成的布料并入共享数组，并把约束指针改指向数组中的粒子。
+    // flat 为真时按平面网格交给求解器（多重网格粗化）
+    size_t append(ClothShape shape, std::vector<Particle>& local_particles, std::vector<Constraint>& local_constraints,
+        std::vector<DihedralConstraint>& local_dihedrals, int grid_rows, int grid_cols, float spacing, bool flat = true);
+};
@@ -9,133 +9,21 @@ SimulationManager::SimulationManager()
 }
 
 void SimulationManager::resetCloth() {
-    particles_.clear();
-    constraints_.clear();
-    int rows_to_use = DEFAULT_ROW;
-    int cols_to_use = DEFAULT_COL;
-    float rest_distance_to_use = DEFAULT_REST_DISTANCE;
-
-    // Constants for cloth generation, matching main.cpp logic
-    const float cloth_width_world =
-        WIDTH; // Assuming WIDTH is world units for initial placement
-    const float cloth_height_world =
-        HEIGHT; // Assuming HEIGHT is world units for initial placement
-
-    if (grid_type_ == GridType::Square) {
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * rest_distance_to_use -
-                          cloth_width_world / 6.f; // Adjusted initial position
-                float y = row * rest_distance_to_use +
-                          cloth_height_world / 6.f; // Adjusted initial position
-                float z =
-                    (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f +
-                    100.0f;
-                bool pinned = (row == 0);
-                particles_.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                if (col < cols_to_use - 1) {
-                    constraints_.emplace_back(
-                        &particles_[row * cols_to_use + col],
-                        &particles_[row * cols_to_use + col + 1],
-                        rest_distance_to_use);
-                }
-                if (row < rows_to_use - 1) {
-                    constraints_.emplace_back(
-                        &particles_[row * cols_to_use + col],
-                        &particles_[(row + 1) * cols_to_use + col],
-                        rest_distance_to_use);
-                }
-            }
-        }
-    } else if (grid_type_ == GridType::Triangle) {
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * rest_distance_to_use - cloth_width_world / 6.f;
-                float y = row * rest_distance_to_use + cloth_height_world / 6.f;
-                float z =
-                    (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f +
-                    100.0f;
-                bool pinned = (row == 0);
-                particles_.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                int idx = row * cols_to_use + col;
-                if (col < cols_to_use - 1) // Right
-                    constraints_.emplace_back(&particles_[idx],
-                                              &particles_[idx + 1],
-                                              rest_distance_to_use);
-                if (row < rows_to_use - 1) // Down
-                    constraints_.emplace_back(&particles_[idx],
-                                              &particles_[idx + cols_to_use],
-                                              rest_distance_to_use);
-                if (col < cols_to_use - 1 &&
-                    row < rows_to_use - 1) // Bottom-right
-                    constraints_.emplace_back(
-                        &particles_[idx], &particles_[idx + cols_to_use + 1],
-                        rest_distance_to_use * std::sqrt(2.f));
-                if (col > 0 && row < rows_to_use - 1) // Bottom-left
-                    constraints_.emplace_back(
-                        &particles_[idx], &particles_[idx + cols_to_use - 1],
-                        rest_distance_to_use * std::sqrt(2.f));
-            }
-        }
-    } else if (grid_type_ == GridType::Hexagon) {
-        float hex_dx = rest_distance_to_use * 0.866f; // cos(30 deg)
-        float hex_dy = rest_distance_to_use * 0.75f;  // row spacing
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                float x = col * hex_dx + (row % 2) * (hex_dx / 2.f) +
-                          cloth_width_world / 6.f;
-                float y = row * hex_dy + cloth_height_world / 6.f;
-                float z =
-                    (float)(col + row) / (rows_to_use + cols_to_use) * 200.0f +
-                    100.0f;
-                bool pinned = (row == 0);
-                particles_.emplace_back(x, y, z, pinned);
-            }
-        }
-        for (int row = 0; row < rows_to_use; row++) {
-            for (int col = 0; col < cols_to_use; col++) {
-                int idx = row * cols_to_use + col;
-                if (col < cols_to_use - 1)
-                    constraints_.emplace_back(&particles_[idx],
-                                              &particles_[idx + 1],
-                                              hex_dx); // Horizontal
-
-                if (row < rows_to_use - 1) {
-                    if (row % 2 == 1) { // Odd rows
-                        if (col > 0)
-                            constraints_.emplace_back(
-                                &particles_[idx],
-                                &particles_[idx + cols_to_use - 1],
-                                rest_distance_to_use); // Bottom-left
-                        constraints_.emplace_back(
-                            &particles_[idx], &particles_[idx + cols_to_use],
-                            rest_distance_to_use); // Approx. Bottom
-                    } else {                       // Even rows
-                        constraints_.emplace_back(
-                            &particles_[idx], &particles_[idx + cols_to_use],
-                            rest_distance_to_use); // Approx. Bottom
-                        if (col < cols_to_use - 1)
-                            constraints_.emplace_back(
-                                &particles_[idx],
-                                &particles_[idx + cols_to_use + 1],
-                                rest_distance_to_use); // Bottom-right
-                    }
-                }
-            }
-        }
-    }
-    // The loop for checking c.initial_length <= 0 from main.cpp seems like a
-    // temporary fix and might indicate an issue in rest_distance calculation
-    // for some constraints. For now, it's omitted, assuming constraints are
-    // well-formed.
+    tearing_.invalidate();
+    // Same placement as main.cpp: top row pinned, a small z ramp along the
+    // diagonal. The topology is cached by build_grid, so repeated resets only
+    // copy the arrays.
+    GridPlacement placement;
+    placement.origin = Vector3f(-WIDTH / 6.f, HEIGHT / 6.f, 100.0f);
+    placement.depth_ramp = 200.0f;
+    placement.pin_top_row = true;
+    build_grid(grid_type_, DEFAULT_ROW, DEFAULT_COL, DEFAULT_REST_DISTANCE,
+               placement, particles_, constraints_, dihedrals_);
+    // Particles are laid out row-major, so the solver can build coarse levels
+    solver_.set_grid(DEFAULT_ROW, DEFAULT_COL, grid_type_);
+    solver_.invalidate_tethers();
+    implicit_integrator_.invalidate();
+    projective_dynamics_.invalidate();
 }
 
 void SimulationManager::applyGravityToParticles() {
@@ -163,10 +51,20 @@ void SimulationManager::constrainParticlesToBounds(float world_width,
 }
 
 void SimulationManager::updatePhysics(float timestep) {
+    applyCommands(); // Step boundary: edits queued since the last step
+    ++step_count_;
     applyGravityToParticles();
     applyWindToParticles();
-    for (auto &particle : particles_) {
-        particle.update(timestep);
+    last_timestep_ = timestep;
+    if (integrator_ == Integrator::ImplicitEuler) {
+        implicit_integrator_.step(particles_, constraints_, timestep);
+    } else if (integrator_ == Integrator::ProjectiveDynamics) {
+        // Integration happens inside satisfyConstraints() together with the
+        // projective dynamics solve
+    } else {
+        for (auto &particle : particles_) {
+            particle.update(timestep);
+        }
     }
     // In main.cpp, constrain_to_bounds was called inside particle.update or
     // after it for each particle. If constrain_to_bounds is part of
@@ -177,12 +75,23 @@ void SimulationManager::updatePhysics(float timestep) {
         1000.0f); // Using constants directly, should be passed or configurable
 }
 
-void SimulationManager::satisfyConstraints(int iterations) {
-    for (int i = 0; i < iterations; i++) {
-        for (auto &constraint : constraints_) {
-            constraint.satisfy();
+SolverStats SimulationManager::satisfyConstraints() {
+    if (integrator_ == Integrator::ProjectiveDynamics) {
+        return projective_dynamics_.step(particles_, constraints_,
+                                         last_timestep_, solver_.settings);
+    }
+    strain_.resize(constraints_.size());
+    SolverStats stats =
+        solver_.solve(particles_, constraints_, dihedrals_, strain_);
+    if (auto_tear_strain_ > 0.0f) {
+        tearing_.collect(constraints_, strain_, auto_tear_strain_);
+        if (tearing_.apply(particles_, constraints_, dihedrals_).broken > 0) {
+            solver_.invalidate_tethers();
+            implicit_integrator_.invalidate();
+            projective_dynamics_.invalidate();
         }
     }
+    return stats;
 }
 
 bool SimulationManager::saveState(const std::string &filename) const {
@@ -201,6 +110,12 @@ bool SimulationManager::loadState(const std::string &filename) {
     if (ClothState::load(temp_particles, temp_constraints, filename)) {
         particles_ = temp_particles;
         constraints_ = temp_constraints;
+        dihedrals_.clear();
+        solver_.set_grid(0, 0); // Imported meshes are not regular grids
+        solver_.invalidate_tethers();
+        implicit_integrator_.invalidate();
+        projective_dynamics_.invalidate();
+        tearing_.invalidate();
         std::cout << "Cloth state loaded from " << filename << std::endl;
         return true;
     }
@@ -211,6 +126,9 @@ bool SimulationManager::loadState(const std::string &filename) {
 void SimulationManager::handleParticleTear(
     Particle *particle_to_remove_constraints_for) {
     if (!particle_to_remove_constraints_for) return;
+    tearing_.invalidate();
+    implicit_integrator_.invalidate();
+    projective_dynamics_.invalidate();
     constraints_.erase(
         std::remove_if(
             constraints_.begin(), constraints_.end(),
@@ -219,6 +137,19 @@ void SimulationManager::handleParticleTear(
                        c.p2 == particle_to_remove_constraints_for;
             }),
         constraints_.end());
+    dihedrals_.erase(
+        std::remove_if(
+            dihedrals_.begin(), dihedrals_.end(),
+            [particle_to_remove_constraints_for](const DihedralConstraint &d) {
+                return d.uses(particle_to_remove_constraints_for);
+            }),
+        dihedrals_.end());
+}
+
+void SimulationManager::togglePin(Particle *particle) {
+    if (!particle) return;
+    particle->is_pinned = !particle->is_pinned;
+    solver_.invalidate_tethers(); // Anchors changed, regenerate tethers
 }
 
 void SimulationManager::setGridType(GridType type) {
@@ -231,4 +162,84 @@ void SimulationManager::adjustWindStrength(float delta) {
     if (wind_strength_ < 0.0f) wind_strength_ = 0.0f; // Prevent negative wind
     if (wind_strength_ > 0.0f && !wind_on_)
         wind_on_ = true; // If wind is adjusted, turn it on
-}
\ No newline at end of file
+}
+
+void SimulationManager::moveParticle(int index, const Vector3f &position) {
+    if (index < 0 || index >= static_cast<int>(particles_.size())) return;
+    particles_[index].position = position;
+    particles_[index].previous_position = position; // Avoid velocity jump
+}
+
+bool SimulationManager::submit(InputEvent command) {
+    command.frame = step_count_.load();
+    return commands_.push(command);
+}
+
+void SimulationManager::applyCommands() {
+    commands_.drain([this](const InputEvent &command) {
+        applyCommand(command);
+        if (recording_)
+            command_log_.record(command);
+    });
+}
+
+void SimulationManager::applyCommand(const InputEvent &command) {
+    const bool valid_particle =
+        command.index >= 0 &&
+        command.index < static_cast<int>(particles_.size());
+    switch (command.type) {
+    case InputEventType::Reset:
+        setGridType(static_cast<GridType>(static_cast<int>(command.value)));
+        break;
+    case InputEventType::DragMove:
+        moveParticle(command.index, command.position);
+        break;
+    case InputEventType::Pin:
+        if (valid_particle) togglePin(&particles_[command.index]);
+        break;
+    case InputEventType::Tear:
+        if (valid_particle) handleParticleTear(&particles_[command.index]);
+        break;
+    case InputEventType::Cut:
+        if (command.index >= 0 &&
+            command.index < static_cast<int>(constraints_.size())) {
+            constraints_[command.index].deactivate();
+            implicit_integrator_.invalidate();
+            projective_dynamics_.invalidate();
+        }
+        break;
+    case InputEventType::Gravity:
+        gravity_ = command.value;
+        break;
+    case InputEventType::Wind:
+        wind_on_ = command.index != 0;
+        wind_strength_ = command.value;
+        break;
+    case InputEventType::Iterations:
+        solver_.settings.max_iterations = static_cast<int>(command.value);
+        break;
+    case InputEventType::Chebyshev:
+        solver_.settings.acceleration = command.value != 0
+                                            ? SolverAcceleration::Chebyshev
+                                            : SolverAcceleration::None;
+        break;
+    case InputEventType::Multigrid:
+        solver_.settings.multigrid = command.value != 0;
+        break;
+    case InputEventType::Integrator:
+        integrator_ = static_cast<Integrator>(static_cast<int>(command.value));
+        break;
+    case InputEventType::AutoTear:
+        setAutoTearStrain(command.value);
+        break;
+    case InputEventType::Load:
+        loadState("cloth_save.txt");
+        break;
+    }
+}
+
+void SimulationManager::setRecording(bool recording) {
+    if (recording && !recording_)
+        command_log_.clear();
+    recording_ = recording;
+}
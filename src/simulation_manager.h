@@ -9,9 +9,14 @@
 #include "vector3f.h"
 #include "constants.h"   // For DEFAULT_ROW, DEFAULT_COL, etc.
 #include "cloth_state.h" // For save/load functionality
-
-// GridType enum, moved from main.cpp
-enum class GridType { Square, Triangle, Hexagon };
+#include "solver.h"
+#include "implicit_integrator.h"
+#include "projective_dynamics.h"
+#include "grid_topology.h" // GridType, shear/bending generation
+#include "command_queue.h"
+#include "input_log.h"
+#include "tearing.h"
+#include <atomic>
 
 class SimulationManager {
   public:
@@ -19,7 +24,9 @@ class SimulationManager {
 
     void resetCloth();
     void updatePhysics(float timestep);
-    void satisfyConstraints(int iterations = 5);
+    // Runs up to the solver's max_iterations sweeps (set through an
+    // InputEventType::Iterations command), stopping early once converged
+    SolverStats satisfyConstraints();
     void applyGravityToParticles();
     void applyWindToParticles();
     void constrainParticlesToBounds(float world_width, float world_height,
@@ -29,6 +36,25 @@ class SimulationManager {
     bool loadState(const std::string &filename);
 
     void handleParticleTear(Particle *particle_to_remove_constraints_for);
+    void togglePin(Particle *particle);
+    void moveParticle(int index, const Vector3f &position);
+
+    // Interactive edits are queued as commands instead of touching particles
+    // directly. The queue is lock-free, so any thread may submit; commands
+    // run in submission order at the start of the next updatePhysics().
+    // Returns false if the queue is full.
+    bool submit(InputEvent command);
+    void applyCommands();
+    void applyCommand(const InputEvent &command);
+    // While recording, every applied command is appended to the command log
+    // with its step number, ready to be saved and replayed
+    void setRecording(bool recording);
+    const InputLog &getCommandLog() const {
+        return command_log_;
+    }
+    uint64_t getStepCount() const {
+        return step_count_.load();
+    }
 
     // Getters
     const std::vector<Particle> &getParticles() const {
@@ -52,6 +78,9 @@ class SimulationManager {
     bool isTearMode() const {
         return tear_mode_;
     }
+    const SolverStats &getSolverStats() const {
+        return solver_.get_last_stats();
+    }
     std::vector<Particle> &getParticlesNonConst() {
         return particles_;
     } // For dragging
@@ -82,15 +111,60 @@ class SimulationManager {
     void setTearMode(bool mode) {
         tear_mode_ = mode;
     }
+    void setSolverTolerance(float tolerance) {
+        solver_.settings.tolerance = tolerance;
+    }
+    void setSolverRelaxation(float omega) {
+        solver_.settings.relaxation = omega;
+    }
+    void setSolverAcceleration(SolverAcceleration acceleration) {
+        solver_.settings.acceleration = acceleration;
+    }
+    void setMultigrid(bool enabled) {
+        solver_.settings.multigrid = enabled;
+    }
+    void setTethers(bool enabled) {
+        solver_.settings.tethers = enabled;
+    }
+    // Sweep `type` every `period` iterations; 0 means once per frame
+    void setBatchPeriod(ConstraintType type, int period) {
+        solver_.settings.batch_period[static_cast<int>(type)] = period;
+    }
+    // Break constraints stretched beyond `strain` (relative); 0 disables
+    void setAutoTearStrain(float strain) {
+        auto_tear_strain_ = strain;
+    }
+    float getAutoTearStrain() const {
+        return auto_tear_strain_;
+    }
+    void setIntegrator(Integrator integrator) {
+        integrator_ = integrator;
+    }
+    Integrator getIntegrator() const {
+        return integrator_;
+    }
 
   private:
     std::vector<Particle> particles_;
     std::vector<Constraint> constraints_;
+    std::vector<DihedralConstraint> dihedrals_;
     GridType grid_type_;
     float gravity_;
     float wind_strength_;
     bool wind_on_;
     bool tear_mode_;
+    ConstraintSolver solver_;
+    std::vector<float> strain_; // Per-constraint strain written by solver_
+    float auto_tear_strain_ = 0.0f;
+    Tearing tearing_;
+    Integrator integrator_ = Integrator::Verlet;
+    ImplicitIntegrator implicit_integrator_;
+    ProjectiveDynamics projective_dynamics_;
+    float last_timestep_ = TIME_STEP;
+    CommandQueue<InputEvent> commands_;
+    InputLog command_log_;
+    bool recording_ = false;
+    std::atomic<uint64_t> step_count_{0};
 };
 
 #endif // SIMULATION_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "software_raster.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t MIN_BAND_ROWS = 32;
+
+// Liang-Barsky：把线段裁剪到 [xmin, xmax] x [ymin, ymax]，完全在外时返回 false
+bool clip_to_rect(float& x0, float& y0, float& x1, float& y1, float xmin, float ymin, float xmax, float ymax)
+{
+    float t0 = 0.0f, t1 = 1.0f;
+    const float dx = x1 - x0, dy = y1 - y0;
+    const float p[4] = { -dx, dx, -dy, dy };
+    const float q[4] = { x0 - xmin, xmax - x0, y0 - ymin, ymax - y0 };
+    for (int k = 0; k < 4; ++k) {
+        if (p[k] == 0.0f) {
+            if (q[k] < 0.0f)
+                return false;
+            continue;
+        }
+        float t = q[k] / p[k];
+        if (p[k] < 0.0f)
+            t0 = std::max(t0, t);
+        else
+            t1 = std::min(t1, t);
+        if (t0 > t1)
+            return false;
+    }
+    x1 = x0 + dx * t1;
+    y1 = y0 + dy * t1;
+    x0 += dx * t0;
+    y0 += dy * t0;
+    return true;
+}
+}
+
+SoftwareRaster::SoftwareRaster(std::span<uint8_t> rgb, int width, int height)
+    : rgb(rgb)
+    , width(width)
+    , height(height)
+{
+}
+
+void SoftwareRaster::clear(Rgb color)
+{
+    parallel_for(static_cast<size_t>(height), MIN_BAND_ROWS, [&](size_t y) {
+        for (int x = 0; x < width; ++x)
+            put(x, static_cast<int>(y), color);
+    });
+}
+
+void SoftwareRaster::draw_points(std::span<const ScreenVertex> points)
+{
+    parallel_for_chunks(static_cast<size_t>(height), MIN_BAND_ROWS, [&](size_t, size_t y0, size_t y1) {
+        for (const auto& v : points) {
+            int x = static_cast<int>(std::floor(v.position.x)), y = static_cast<int>(std::floor(v.position.y));
+            if (x >= 0 && x < width && y >= static_cast<int>(y0) && y < static_cast<int>(y1))
+                put(x, y, v.color);
+        }
+    });
+}
+
+void SoftwareRaster::draw_lines(std::span<const ScreenVertex> vertices)
+{
+    parallel_for_chunks(static_cast<size_t>(height), MIN_BAND_ROWS, [&](size_t, size_t y0, size_t y1) {
+        for (size_t k = 0; k + 1 < vertices.size(); k += 2)
+            line_in_band(vertices[k], vertices[k + 1], static_cast<int>(y0), static_cast<int>(y1));
+    });
+}
+
+void SoftwareRaster::draw_triangles(std::span<const ScreenVertex> vertices)
+{
+    parallel_for_chunks(static_cast<size_t>(height), MIN_BAND_ROWS, [&](size_t, size_t y0, size_t y1) {
+        for (size_t k = 0; k + 2 < vertices.size(); k += 3)
+            triangle_in_band(&vertices[k], static_cast<int>(y0), static_cast<int>(y1));
+    });
+}
+
+// 先裁剪到整幅图像再做 DDA，各条带只写自己那几行；像素位置与分带无关
+void SoftwareRaster::line_in_band(const ScreenVertex& a, const ScreenVertex& b, int y0, int y1)
+{
+    float xa = a.position.x, ya = a.position.y, xb = b.position.x, yb = b.position.y;
+    if (!clip_to_rect(xa, ya, xb, yb, -0.5f, -0.5f, width - 0.5f, height - 0.5f))
+        return;
+    const float dx = xb - xa, dy = yb - ya;
+    const int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy)))));
+    // 只遍历落在本条带内的那一段
+    int first = 0, last = steps;
+    if (std::abs(dy) > 1e-6f) {
+        float lo = (y0 - 0.5f - ya) * steps / dy, hi = (y1 - 0.5f - ya) * steps / dy;
+        if (lo > hi)
+            std::swap(lo, hi);
+        first = std::max(first, static_cast<int>(std::floor(lo)) - 1);
+        last = std::min(last, static_cast<int>(std::ceil(hi)) + 1);
+    }
+    for (int i = first; i <= last; ++i) {
+        float t = static_cast<float>(i) / steps;
+        int x = static_cast<int>(std::floor(xa + dx * t + 0.5f));
+        int y = static_cast<int>(std::floor(ya + dy * t + 0.5f));
+        if (y >= y0 && y < y1 && x >= 0 && x < width)
+            put(x, y, a.color);
+    }
+}
+
+// 边函数法：像素中心落在三角形内（含边界）即着色，颜色按重心坐标插值
+void SoftwareRaster::triangle_in_band(const ScreenVertex* v, int y0, int y1)
+{
+    const ScreenPoint p0 = v[0].position, p1 = v[1].position, p2 = v[2].position;
+    const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (std::abs(area) < 1e-8f)
+        return;
+    const int min_x = std::max(0, static_cast<int>(std::floor(std::min({ p0.x, p1.x, p2.x }))));
+    const int max_x = std::min(width - 1, static_cast<int>(std::ceil(std::max({ p0.x, p1.x, p2.x }))));
+    const int min_y = std::max(y0, static_cast<int>(std::floor(std::min({ p0.y, p1.y, p2.y }))));
+    const int max_y = std::min(y1 - 1, static_cast<int>(std::ceil(std::max({ p0.y, p1.y, p2.y }))));
+    const float inv_area = 1.0f / area;
+    auto edge = [](ScreenPoint a, ScreenPoint b, float x, float y) { return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x); };
+    for (int y = min_y; y <= max_y; ++y) {
+        const float py = y + 0.5f;
+        for (int x = min_x; x <= max_x; ++x) {
+            const float px = x + 0.5f;
+            const float w0 = edge(p1, p2, px, py) * inv_area;
+            const float w1 = edge(p2, p0, px, py) * inv_area;
+            const float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                continue;
+            put(x, y, { static_cast<uint8_t>(w0 * v[0].color.r + w1 * v[1].color.r + w2 * v[2].color.r + 0.5f),
+                           static_cast<uint8_t>(w0 * v[0].color.g + w1 * v[1].color.g + w2 * v[2].color.g + 0.5f),
+                           static_cast<uint8_t>(w0 * v[0].color.b + w1 * v[1].color.b + w2 * v[2].color.b + 0.5f) });
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "frustum.h"
+#include <cstdint>
+#include <span>
+
+// 软件光栅化：画进调用方提供的 RGB 缓冲区（每像素 3 字节，行优先），不需要显示器和 OpenGL。
+// 图像按行分成若干条带并行绘制，每条带按提交顺序画完全部图元；
+// 每个像素只由它所在的条带写入，结果与分带方式无关
+class SoftwareRaster {
+public:
+    SoftwareRaster(std::span<uint8_t> rgb, int width, int height);
+
+    std::span<uint8_t> pixels() const { return rgb; }
+
+    void clear(Rgb color);
+    // 每个顶点一个像素
+    void draw_points(std::span<const ScreenVertex> points);
+    // 每 2 个顶点一条线，用起点的颜色
+    void draw_lines(std::span<const ScreenVertex> vertices);
+    // 每 3 个顶点一个三角形，颜色在三角形内线性插值
+    void draw_triangles(std::span<const ScreenVertex> vertices);
+
+private:
+    std::span<uint8_t> rgb;
+    int width, height;
+
+    void put(int x, int y, Rgb color)
+    {
+        uint8_t* p = rgb.data() + (static_cast<size_t>(y) * width + x) * 3;
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+    }
+    void line_in_band(const ScreenVertex& a, const ScreenVertex& b, int y0, int y1);
+    void triangle_in_band(const ScreenVertex* v, int y0, int y1);
+};
@@ -0,0 +1,366 @@
+#include "solver.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+static bool runs_on(int period, int k)
+{
+    return period <= 0 ? k == 0 : k % period == 0;
+}
+
+namespace {
+const size_t MIN_COLOR_CHUNK = 2048; // 同色约束每个并行块至少的条数
+
+// 一段约束的扫描结果，按块序合并
+struct SweepPartial {
+    float max_error = 0.0f;
+    float sum_sq = 0.0f;
+    size_t measured = 0;
+    size_t active = 0;
+};
+
+// 规则网格上一个同色组第 [slot_begin, slot_end) 个参与行的隐式扫描：粒子下标由行列算出，
+// 约束数组一条都不读；first 为这段第一条约束在数组中的下标，用于写应变。
+// 逐对调用 Constraint::project，结果与逐条 satisfy 逐位一致
+template <GridType G>
+void sweep_stencil(const GridStencil& s, int cols, int slot_begin, int slot_end, size_t first, Particle* particles,
+    float rest_length, float stiffness, float relaxation, std::span<float> strain, bool measure, SweepPartial& part)
+{
+    // 误差累加在局部变量里：part 与粒子坐标同为 float，留在内存里会被当作可能别名而逐条存取
+    float max_error = part.max_error, sum_sq = part.sum_sq;
+    size_t index = first;
+    for_each_stencil_edge<G>(s, cols, slot_begin, slot_end, [&](int i, int j) {
+        const float e = Constraint::project(particles[i], particles[j], rest_length, stiffness, relaxation);
+        if (!strain.empty())
+            strain[index] = e;
+        ++index;
+        if (measure) {
+            max_error = std::max(max_error, e);
+            sum_sq += e * e;
+        }
+    });
+    part.active += index - first;
+    if (measure) {
+        part.max_error = max_error;
+        part.sum_sq = sum_sq;
+        part.measured += index - first;
+    }
+}
+
+// 同色组前 slot 个参与行内的约束数（方格、三角形的表里 dc_odd == dc，按六边形的规则数即可）
+size_t stencil_edges_before(const GridStencil& s, int cols, int slot)
+{
+    size_t count = 0;
+    for (int k = 0; k < slot; ++k)
+        count += stencil_row<GridType::Hexagon>(s, k, cols).count(s.col_mod);
+    return count;
+}
+
+void merge_partials(SweepPartial& total, std::span<const SweepPartial> partial)
+{
+    for (const SweepPartial& p : partial) {
+        total.max_error = std::max(total.max_error, p.max_error);
+        total.sum_sq += p.sum_sq;
+        total.measured += p.measured;
+        total.active += p.active;
+    }
+}
+
+// 一个同色组的隐式扫描：按参与行分块并行，数组中从 begin 起的 count 条约束与之一一对应
+void sweep_grid_batch(GridType type, const GridStencil& s, int rows, int cols, size_t begin, size_t count,
+    Particle* particles, float rest_length, float stiffness, float relaxation, std::span<float> strain, bool measure,
+    SweepPartial& total)
+{
+    auto run = [&](int slot_begin, int slot_end, SweepPartial& part) {
+        const size_t first = begin + stencil_edges_before(s, cols, slot_begin);
+        switch (type) {
+        case GridType::Square:
+            sweep_stencil<GridType::Square>(s, cols, slot_begin, slot_end, first, particles, rest_length, stiffness, relaxation, strain, measure, part);
+            break;
+        case GridType::Triangle:
+            sweep_stencil<GridType::Triangle>(s, cols, slot_begin, slot_end, first, particles, rest_length, stiffness, relaxation, strain, measure, part);
+            break;
+        default:
+            sweep_stencil<GridType::Hexagon>(s, cols, slot_begin, slot_end, first, particles, rest_length, stiffness, relaxation, strain, measure, part);
+            break;
+        }
+    };
+    const size_t slots = static_cast<size_t>(s.row_count(rows));
+    const size_t min_rows = std::max<size_t>(MIN_COLOR_CHUNK * slots / std::max<size_t>(count, 1), 1);
+    if (parallel_chunk_count(slots, min_rows) <= 1) {
+        run(0, static_cast<int>(slots), total);
+        return;
+    }
+    ScratchArena& arena = TaskScheduler::scratch();
+    ScratchScope scope(arena);
+    std::span<SweepPartial> partial = arena.allocate<SweepPartial>(parallel_chunk_count(slots, min_rows));
+    parallel_for_chunks(slots, min_rows, [&](size_t chunk, size_t slot_begin, size_t slot_end) {
+        run(static_cast<int>(slot_begin), static_cast<int>(slot_end), partial[chunk]);
+    });
+    merge_partials(total, partial);
+}
+}
+
+// 一轮 Gauss-Seidel 扫描，同时统计投影前的最大/均方根误差。
+// 同色批次内的约束互不共用粒子，投影顺序不影响结果，按块并行；未着色的批次串行。
+// 提前退出前不知道哪一轮是最后一轮，所以每轮都写应变，最后一次写入的即为最终值
+void ConstraintSolver::sweep(int k, std::span<Particle> particles, std::span<Constraint> constraints,
+    std::span<DihedralConstraint> dihedrals, std::span<float> strain, bool grid_kernels, SolverStats& stats,
+    size_t& active) const
+{
+    using clock = std::chrono::steady_clock;
+    SweepPartial total;
+    std::array<bool, CONSTRAINT_TYPE_COUNT> swept {};
+    const bool record = !strain.empty();
+    for (size_t b = 0; b < batches.size(); ++b) {
+        const ConstraintBatch& batch = batches[b];
+        const int type = static_cast<int>(batch.type);
+        if (!runs_on(settings.batch_period[type], k))
+            continue;
+        // 剪切、弯曲是柔性约束（刚度 < 1），本就不会收敛到零，不计入误差
+        const bool measure = batch.type == ConstraintType::Structural;
+        auto project = [&](size_t begin, size_t end, SweepPartial& part) {
+            for (size_t i = begin; i < end; ++i) {
+                Constraint& c = constraints[i];
+                if (!c.active)
+                    continue;
+                float e = c.satisfy(settings.relaxation);
+                ++part.active;
+                if (record)
+                    strain[i] = e;
+                if (!measure)
+                    continue;
+                part.max_error = std::max(part.max_error, e);
+                part.sum_sq += e * e;
+                ++part.measured;
+            }
+        };
+        auto start = clock::now();
+        const size_t count = batch.end - batch.begin;
+        const GridBatch& grid = grid_batches[b];
+        if (grid_kernels && grid.stencil) {
+            sweep_grid_batch(grid_type, *grid.stencil, grid_rows, grid_cols, batch.begin, count, particles.data(),
+                grid.rest_length, grid.stiffness, settings.relaxation, strain, measure, total);
+        } else if (batch.color == Constraint::NO_COLOR || parallel_chunk_count(count, MIN_COLOR_CHUNK) <= 1) {
+            project(batch.begin, batch.end, total);
+        } else {
+            ScratchArena& arena = TaskScheduler::scratch();
+            ScratchScope scope(arena);
+            std::span<SweepPartial> partial = arena.allocate<SweepPartial>(parallel_chunk_count(count, MIN_COLOR_CHUNK));
+            parallel_for_chunks(count, MIN_COLOR_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+                project(batch.begin + begin, batch.begin + end, partial[chunk]);
+            });
+            merge_partials(total, partial);
+        }
+        stats.batch_ms[type] += std::chrono::duration<float, std::milli>(clock::now() - start).count();
+        swept[type] = true;
+    }
+    for (int type = 0; type < CONSTRAINT_TYPE_COUNT; ++type)
+        stats.batch_sweeps[type] += swept[type] ? 1 : 0;
+    active = total.active;
+    // 二面角弯曲与隔点弯曲同频
+    const int bending = static_cast<int>(ConstraintType::Bending);
+    if (!dihedrals.empty() && runs_on(settings.batch_period[bending], k)) {
+        auto start = clock::now();
+        for (auto& d : dihedrals) {
+            if (d.active)
+                d.satisfy(settings.relaxation);
+        }
+        stats.batch_ms[bending] += std::chrono::duration<float, std::milli>(clock::now() - start).count();
+    }
+    stats.max_error = total.max_error;
+    stats.rms_error = total.measured > 0 ? std::sqrt(total.sum_sq / total.measured) : 0.0f;
+}
+
+uint64_t ConstraintSolver::topology_key(size_t particle_count, size_t active_count) const
+{
+    uint32_t omega_bits;
+    std::memcpy(&omega_bits, &settings.relaxation, sizeof(omega_bits));
+    uint64_t key = particle_count;
+    key = key * 1000003u ^ active_count;
+    key = key * 1000003u ^ omega_bits;
+    return key;
+}
+
+// 保存当前位置到 dst
+static void store_positions(std::span<const Particle> particles, std::vector<Vector3f>& dst)
+{
+    dst.resize(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i)
+        dst[i] = particles[i].position;
+}
+
+// 本轮位置更新量的平方和
+static float update_norm_sq(std::span<const Particle> particles, const std::vector<Vector3f>& before)
+{
+    float sum = 0.0f;
+    for (size_t i = 0; i < particles.size(); ++i) {
+        Vector3f d = particles[i].position - before[i];
+        sum += d.dot(d);
+    }
+    return sum;
+}
+
+// 逐条核对批次是否正好是某个同色组按行优先生成的约束，只在批次重切或网格改变后做一次
+void ConstraintSolver::match_grid_batches(std::span<const Particle> particles, std::span<const Constraint> constraints)
+{
+    grid_batches.assign(batches.size(), GridBatch());
+    grid_batches_dirty = false;
+    if (grid_rows < 2 || grid_cols < 2 || particles.size() != static_cast<size_t>(grid_rows) * grid_cols)
+        return;
+    const Particle* base = particles.data();
+    for (size_t b = 0; b < batches.size(); ++b) {
+        const ConstraintBatch& batch = batches[b];
+        std::span<const GridStencil> stencils = grid_stencils(grid_type, batch.type);
+        if (batch.color >= stencils.size())
+            continue;
+        const GridStencil& s = stencils[batch.color];
+        const Constraint& head = constraints[batch.begin];
+        size_t n = batch.begin;
+        bool match = true;
+        for_each_stencil_edge<GridType::Hexagon>(s, grid_cols, 0, s.row_count(grid_rows), [&](int i, int j) {
+            if (!match || n >= batch.end) {
+                match = false;
+                return;
+            }
+            const Constraint& c = constraints[n++];
+            match = c.p1 == base + i && c.p2 == base + j && c.initial_length == head.initial_length && c.stiffness == head.stiffness;
+        });
+        if (match && n == batch.end) {
+            grid_batches[b] = { &s, head.initial_length, head.stiffness, static_cast<int>(head.p1 - base),
+                static_cast<int>(constraints[batch.end - 1].p2 - base) };
+        }
+    }
+}
+
+bool ConstraintSolver::grid_kernels_usable(std::span<const Particle> particles, std::span<const Constraint> constraints,
+    size_t active_count) const
+{
+    if (particles.size() != static_cast<size_t>(grid_rows) * grid_cols || active_count != constraints.size())
+        return false;
+    const Particle* base = particles.data();
+    bool any = false;
+    for (size_t b = 0; b < batches.size(); ++b) {
+        const GridBatch& grid = grid_batches[b];
+        if (!grid.stencil)
+            continue;
+        if (constraints[batches[b].begin].p1 != base + grid.first || constraints[batches[b].end - 1].p2 != base + grid.last)
+            return false;
+        any = true;
+    }
+    return any;
+}
+
+SolverStats ConstraintSolver::solve(std::span<Particle> particles, std::span<Constraint> constraints)
+{
+    return solve(particles, constraints, {});
+}
+
+SolverStats ConstraintSolver::solve(std::span<Particle> particles, std::span<Constraint> constraints,
+    std::span<DihedralConstraint> dihedrals, std::span<float> strain)
+{
+    SolverStats stats;
+    const bool chebyshev = settings.acceleration == SolverAcceleration::Chebyshev;
+    size_t active = 0;
+
+    // 谱半径：命中缓存则加速，否则本次用普通迭代估计收敛率
+    float rho = 0.0f;
+    bool estimating = false;
+    uint64_t key = 0;
+    float last_norm = 0.0f;
+    float last_rms = 0.0f;
+    float omega = 1.0f;
+    int accel_step = 0; // 距上次（重新）开始加速的迭代数
+
+    // 数组未变时只核对批次边界
+    bool batches_valid = constraints.data() == batches_data && constraints.size() == batches_size;
+    for (size_t b = 0; b < batches.size() && batches_valid; ++b)
+        batches_valid = constraints[batches[b].begin].type == batches[b].type && constraints[batches[b].end - 1].type == batches[b].type
+            && constraints[batches[b].begin].color == batches[b].color && constraints[batches[b].end - 1].color == batches[b].color;
+    if (!batches_valid) {
+        batches = constraint_batches(constraints);
+        batches_data = constraints.data();
+        batches_size = constraints.size();
+    }
+    if (!batches_valid || grid_batches_dirty)
+        match_grid_batches(particles, constraints);
+    const bool grid_candidate = std::any_of(grid_batches.begin(), grid_batches.end(), [](const GridBatch& g) { return g.stencil; });
+
+    // 隐式网格扫描不读约束的 active 标志，先确认一条都没有断开
+    size_t active_count = 0;
+    if (settings.multigrid || settings.tethers || grid_candidate)
+        active_count = std::count_if(constraints.begin(), constraints.end(), [](const Constraint& c) { return c.active; });
+    const bool grid_kernels = grid_candidate && grid_kernels_usable(particles, constraints, active_count);
+
+    // 长程附着：一次投影即可消除远离固定点处的累积拉伸
+    if (settings.tethers) {
+        if (tethers_dirty || active_count != tether_active_count) {
+            tether_set.rebuild(particles, constraints);
+            tether_active_count = active_count;
+            tethers_dirty = false;
+        }
+        tether_set.apply(particles);
+        stats.tethers = tether_set.size();
+    }
+
+    if (settings.multigrid) {
+        if (multigrid.prepare(particles, constraints, active_count)) {
+            multigrid.solve(particles, settings.coarse_iterations, settings.relaxation);
+            stats.multigrid_levels = multigrid.level_count();
+        }
+    }
+
+    for (int k = 0; k < settings.max_iterations; ++k) {
+        if (chebyshev)
+            store_positions(particles, curr_iterate);
+
+        sweep(k, particles, constraints, dihedrals, strain, grid_kernels, stats, active);
+        stats.iterations = k + 1;
+
+        if (chebyshev) {
+            if (k == 0) {
+                key = topology_key(particles.size(), active);
+                auto it = spectral_radius_cache.find(key);
+                estimating = it == spectral_radius_cache.end();
+                if (!estimating)
+                    rho = it->second;
+            }
+            if (estimating) {
+                float norm = std::sqrt(update_norm_sq(particles, curr_iterate));
+                if (k > 0 && last_norm > 0.0f)
+                    rho = std::min(norm / last_norm * CHEBYSHEV_SAFETY, 0.99f);
+                last_norm = norm;
+            } else if (k > 0 && stats.rms_error > last_rms) {
+                // 误差回升说明 ρ 估计偏大：调低缓存值并从本轮重新开始加速
+                rho *= CHEBYSHEV_SAFETY;
+                spectral_radius_cache[key] = rho;
+                accel_step = 0;
+            } else if (++accel_step > 1) {
+                // x_{k+1} = ω_{k+1} (x̂_{k+1} - x_{k-1}) + x_{k-1}
+                omega = (accel_step == 2) ? 2.0f / (2.0f - rho * rho) : 4.0f / (4.0f - rho * rho * omega);
+                for (size_t i = 0; i < particles.size(); ++i) {
+                    Particle& p = particles[i];
+                    if (p.is_pinned)
+                        continue;
+                    p.position = (p.position - prev_iterate[i]) * omega + prev_iterate[i];
+                }
+            }
+            std::swap(prev_iterate, curr_iterate);
+            last_rms = stats.rms_error;
+        }
+
+        // 误差是投影前测得的，低于阈值说明本轮已几乎不再修正
+        if (stats.max_error < settings.tolerance)
+            break;
+    }
+
+    if (chebyshev) {
+        if (estimating && stats.iterations >= 3)
+            spectral_radius_cache[key] = rho;
+        stats.spectral_radius = rho;
+    }
+    last_stats = stats;
+    return stats;
+}
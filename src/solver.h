@@ -0,0 +1,111 @@
+#pragma once
+#include "constants.h"
+#include "constraint.h"
+#include "dihedral_constraint.h"
+#include "grid_topology.h"
+#include "multigrid.h"
+#include "particle.h"
+#include "tether.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// 迭代加速方式
+enum class SolverAcceleration {
+    None, // 普通 Gauss-Seidel（可配合松弛因子，即 SOR）
+    Chebyshev // Chebyshev 半迭代加速
+};
+
+// 约束求解参数
+struct SolverSettings {
+    int max_iterations = MAX_SOLVER_ITER; // 迭代次数上限
+    float tolerance = SOLVER_TOLERANCE; // 收敛阈值（最大相对误差）
+    float relaxation = SOLVER_RELAXATION; // 松弛因子 ω，1 为普通 Gauss-Seidel，(1, 2) 为超松弛
+    SolverAcceleration acceleration = SolverAcceleration::None;
+    bool multigrid = false; // 规则网格上先做粗层求解
+    int coarse_iterations = MULTIGRID_COARSE_ITER; // 每个粗层的迭代次数
+    bool tethers = true; // 对固定粒子的长程附着约束
+    // 按约束类别（ConstraintType）的求解周期：每 N 次迭代扫描一次，0 为每帧一次
+    std::array<int, CONSTRAINT_TYPE_COUNT> batch_period = { STRUCTURAL_PERIOD, SHEAR_PERIOD, BENDING_PERIOD };
+};
+
+// 单次求解的统计信息（供 HUD 显示）
+struct SolverStats {
+    int iterations = 0; // 实际使用的迭代次数
+    float max_error = 0.0f; // 最后一次迭代的最大相对误差
+    float rms_error = 0.0f; // 最后一次迭代的均方根相对误差
+    float spectral_radius = 0.0f; // 当前拓扑的谱半径估计（Chebyshev 模式）
+    int multigrid_levels = 0; // 本次使用的粗层数
+    size_t tethers = 0; // 生效的长程附着约束数
+    std::array<int, CONSTRAINT_TYPE_COUNT> batch_sweeps {}; // 各类约束本次被扫描的次数
+    std::array<float, CONSTRAINT_TYPE_COUNT> batch_ms {}; // 各类约束本次的扫描耗时（毫秒）
+};
+
+// Gauss-Seidel 约束求解器：每次迭代顺带统计误差，收敛后提前退出
+class ConstraintSolver {
+public:
+    SolverSettings settings;
+
+    SolverStats solve(std::span<Particle> particles, std::span<Constraint> constraints);
+    // 每轮在距离约束之后再扫描一遍二面角弯曲约束；误差统计只含结构约束。
+    // strain 非空时（与 constraints 等长）顺带写出每条有效约束在最后一次扫描时的相对应变，供渲染着色
+    SolverStats solve(std::span<Particle> particles, std::span<Constraint> constraints,
+        std::span<DihedralConstraint> dihedrals, std::span<float> strain = {});
+    const SolverStats& get_last_stats() const { return last_stats; }
+
+    // 告知粒子排布的网格行列数和类型，供多重网格建立粗层，并让生成的同色组改用隐式网格扫描；导入的网格传 0
+    void set_grid(int rows, int cols, GridType type = GridType::Square)
+    {
+        multigrid.set_grid(rows, cols, type);
+        grid_rows = rows;
+        grid_cols = cols;
+        grid_type = type;
+        grid_batches_dirty = true;
+    }
+
+    // 固定状态变化（切换固定、重置、加载）后调用，下次求解时重建长程附着约束
+    void invalidate_tethers() { tethers_dirty = true; }
+
+private:
+    SolverStats last_stats;
+    Multigrid multigrid;
+    TetherSet tether_set;
+    bool tethers_dirty = true;
+    size_t tether_active_count = 0;
+
+    // 按拓扑缓存的谱半径估计，键由粒子数、有效约束数和松弛因子组成
+    std::unordered_map<uint64_t, float> spectral_radius_cache;
+    std::vector<Vector3f> prev_iterate; // x_{k-1}
+    std::vector<Vector3f> curr_iterate; // x_k
+
+    // 约束数组按类别和颜色切成的连续批次，数组变化时重新切分
+    std::vector<ConstraintBatch> batches;
+    const Constraint* batches_data = nullptr;
+    size_t batches_size = 0;
+
+    // 与 batches 一一对应：批次正好是 build_grid 按某个 GridStencil 生成的同色组时记下该组，
+    // 静止长度和刚度在组内一致；扫描时直接由行列算出粒子下标，不再读约束数组
+    struct GridBatch {
+        const GridStencil* stencil = nullptr; // nullptr 表示走通用约束列表
+        float rest_length = 0.0f;
+        float stiffness = 1.0f;
+        int first = 0, last = 0; // 首条约束的起点、末条约束的终点，每次求解前核对
+    };
+    std::vector<GridBatch> grid_batches;
+    GridType grid_type = GridType::Square;
+    int grid_rows = 0, grid_cols = 0;
+    bool grid_batches_dirty = true;
+
+    void match_grid_batches(std::span<const Particle> particles, std::span<const Constraint> constraints);
+    // 网格未撕裂（粒子数不变、约束全部有效）且各组首尾仍在原位时才可用隐式扫描
+    bool grid_kernels_usable(std::span<const Particle> particles, std::span<const Constraint> constraints,
+        size_t active_count) const;
+
+    // 第 k 次迭代：按各批次的周期扫描，误差只统计结构约束；grid_kernels 为真时匹配的同色组走隐式扫描
+    void sweep(int k, std::span<Particle> particles, std::span<Constraint> constraints,
+        std::span<DihedralConstraint> dihedrals, std::span<float> strain, bool grid_kernels, SolverStats& stats,
+        size_t& active) const;
+    uint64_t topology_key(size_t particle_count, size_t active_count) const;
+};
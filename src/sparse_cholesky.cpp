@@ -0,0 +1,176 @@
+#include "sparse_cholesky.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+void SparseCholesky::analyze(int n_, const std::vector<std::pair<int, int>>& edges)
+{
+    n = n_;
+    valid = false;
+    std::vector<std::vector<int>> adjacency(n);
+    for (auto [a, b] : edges) {
+        if (a == b)
+            continue;
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+    }
+    for (auto& adj : adjacency) {
+        std::sort(adj.begin(), adj.end());
+        adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+    }
+
+    // 逆 Cuthill-McKee：每个连通分量从度最小的点开始按度数升序 BFS
+    perm.clear();
+    perm.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return adjacency[a].size() < adjacency[b].size(); });
+    std::vector<int> neighbors;
+    for (int start : order) {
+        if (visited[start])
+            continue;
+        std::queue<int> queue;
+        queue.push(start);
+        visited[start] = 1;
+        while (!queue.empty()) {
+            int u = queue.front();
+            queue.pop();
+            perm.push_back(u);
+            neighbors.clear();
+            for (int v : adjacency[u])
+                if (!visited[v])
+                    neighbors.push_back(v);
+            std::stable_sort(neighbors.begin(), neighbors.end(), [&](int a, int b) { return adjacency[a].size() < adjacency[b].size(); });
+            for (int v : neighbors) {
+                visited[v] = 1;
+                queue.push(v);
+            }
+        }
+    }
+    std::reverse(perm.begin(), perm.end());
+    inverse_perm.assign(n, 0);
+    for (int i = 0; i < n; ++i)
+        inverse_perm[perm[i]] = i;
+
+    // 包络：每行最左的非零列
+    first.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        int row = inverse_perm[i];
+        int f = row;
+        for (int v : adjacency[i])
+            f = std::min(f, inverse_perm[v]);
+        first[row] = f;
+    }
+    row_start.assign(n + 1, 0);
+    for (int i = 0; i < n; ++i)
+        row_start[i + 1] = row_start[i] + (i - first[i] + 1);
+    column_end.assign(n, 0);
+    for (int i = 0; i < n; ++i)
+        for (int k = first[i]; k <= i; ++k)
+            column_end[k] = std::max(column_end[k], i);
+    values.assign(row_start[n], 0.0);
+    work.assign(n, 0.0);
+}
+
+bool SparseCholesky::factor(const std::vector<double>& diag, const std::vector<std::pair<int, int>>& edges, const std::vector<double>& weights)
+{
+    std::fill(values.begin(), values.end(), 0.0);
+    for (int i = 0; i < n; ++i)
+        at(inverse_perm[i], inverse_perm[i]) = diag[i];
+    for (size_t e = 0; e < edges.size(); ++e) {
+        auto [a, b] = edges[e];
+        double weight = weights[e];
+        int i = inverse_perm[a], j = inverse_perm[b];
+        if (i < j)
+            std::swap(i, j);
+        at(i, i) += weight;
+        at(j, j) += weight;
+        at(i, j) -= weight;
+    }
+
+    // 按行的包络 Cholesky
+    for (int i = 0; i < n; ++i) {
+        for (int j = first[i]; j <= i; ++j) {
+            double sum = at(i, j);
+            int k0 = std::max(first[i], first[j]);
+            const double* li = &values[row_start[i] + (k0 - first[i])];
+            const double* lj = &values[row_start[j] + (k0 - first[j])];
+            for (int k = k0; k < j; ++k)
+                sum -= *li++ * *lj++;
+            if (j < i) {
+                at(i, j) = sum / at(j, j);
+            } else {
+                if (sum <= 0.0)
+                    return valid = false;
+                at(i, i) = std::sqrt(sum);
+            }
+        }
+    }
+    return valid = true;
+}
+
+bool SparseCholesky::rank_one(int a, int b, double weight, double sign)
+{
+    if (!valid)
+        return false;
+    // w 只在包络内传播，因此更新不会产生包络外的填充
+    std::fill(work.begin(), work.end(), 0.0);
+    double root = std::sqrt(weight);
+    int ia = inverse_perm[a];
+    work[ia] = root;
+    int start = ia;
+    if (b >= 0) {
+        int ib = inverse_perm[b];
+        work[ib] = -root;
+        start = std::min(ia, ib);
+    }
+    for (int k = start; k < n; ++k) {
+        double wk = work[k];
+        if (wk == 0.0)
+            continue;
+        double lkk = at(k, k);
+        double r2 = lkk * lkk + sign * wk * wk;
+        if (r2 <= 0.0)
+            return valid = false;
+        double r = std::sqrt(r2);
+        double c = r / lkk;
+        double s = wk / lkk;
+        at(k, k) = r;
+        for (int i = k + 1; i <= column_end[k]; ++i) {
+            if (first[i] > k)
+                continue;
+            double& lik = at(i, k);
+            lik = (lik + sign * s * work[i]) / c;
+            work[i] = c * work[i] - s * lik;
+        }
+    }
+    return true;
+}
+
+void SparseCholesky::solve(std::vector<double>& rhs, std::vector<double>& work) const
+{
+    work.resize(n);
+    // 重排到新序号
+    for (int i = 0; i < n; ++i)
+        work[i] = rhs[perm[i]];
+    // L y = b
+    for (int i = 0; i < n; ++i) {
+        double sum = work[i];
+        const double* li = &values[row_start[i]];
+        for (int k = first[i]; k < i; ++k)
+            sum -= *li++ * work[k];
+        work[i] = sum / at(i, i);
+    }
+    // L^T x = y
+    for (int i = n - 1; i >= 0; --i) {
+        work[i] /= at(i, i);
+        double xi = work[i];
+        const double* li = &values[row_start[i]];
+        for (int k = first[i]; k < i; ++k)
+            work[k] -= *li++ * xi;
+    }
+    for (int i = 0; i < n; ++i)
+        rhs[perm[i]] = work[i];
+}
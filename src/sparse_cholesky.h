@@ -0,0 +1,38 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+// 对称正定稀疏矩阵的包络（skyline）Cholesky 分解 A = L L^T。
+// 先用逆 Cuthill-McKee 重排缩小带宽，L 按行存储每行第一个非零列到对角线的区间。
+// 支持秩一更新/降秩（A ± w w^T），拓扑局部变化时无需重新分解。
+class SparseCholesky {
+public:
+    // 根据非零结构（对角线之外的边）计算重排和包络
+    void analyze(int n, const std::vector<std::pair<int, int>>& edges);
+
+    // 分解 A = diag + Σ weights[e] * (e_a - e_b)(e_a - e_b)^T，diag 为对角附加项
+    bool factor(const std::vector<double>& diag, const std::vector<std::pair<int, int>>& edges, const std::vector<double>& weights);
+
+    // 秩一修改：A += sign * weight * (e_a - e_b)(e_a - e_b)^T；b < 0 时为 sign * weight * e_a e_a^T
+    bool rank_one(int a, int b, double weight, double sign);
+
+    // 原地求解 A x = rhs（rhs 为原始顺序），scratch 为调用方提供的临时空间，便于多个右端项并行求解
+    void solve(std::vector<double>& rhs, std::vector<double>& scratch) const;
+
+    int size() const { return n; }
+    bool is_valid() const { return valid; }
+
+private:
+    int n = 0;
+    bool valid = false;
+    std::vector<int> perm; // 新序号 -> 原序号
+    std::vector<int> inverse_perm; // 原序号 -> 新序号
+    std::vector<int> first; // 每行（新序号）包络起始列
+    std::vector<int> row_start; // 每行在 values 中的偏移，行 i 的元素 (i, first[i] .. i)
+    std::vector<int> column_end; // 第 k 列中可能非零的最后一行
+    std::vector<double> values;
+    std::vector<double> work;
+
+    double& at(int i, int j) { return values[row_start[i] + (j - first[i])]; }
+    double at(int i, int j) const { return values[row_start[i] + (j - first[i])]; }
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "constants.h"
+#include "frustum.h"
+#include <algorithm>
+#include <array>
+
+// 应变热度图：相对应变 0 为白色，达到 STRAIN_COLOR_FULL 及以上为纯红，中间线性过渡。
+// 256 级查表，画线时不再逐条做除法和取整
+inline Rgb strain_color(float strain)
+{
+    static constexpr std::array<Rgb, 256> table = [] {
+        std::array<Rgb, 256> t {};
+        for (int i = 0; i < 256; ++i) {
+            const uint8_t fade = static_cast<uint8_t>(255 - i);
+            t[i] = { 255, fade, fade };
+        }
+        return t;
+    }();
+    const float index = strain * (255.0f / STRAIN_COLOR_FULL);
+    return table[index < 255.0f ? static_cast<int>(std::max(index, 0.0f)) : 255];
+}
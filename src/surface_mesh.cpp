@@ -0,0 +1,176 @@
+#include "surface_mesh.h"
+#include "constants.h"
+#include "grid_topology.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace {
+const size_t MIN_CHUNK = 2048;
+const Rgb SURFACE_BASE_COLOR { 215, 130, 95 }; // 布面底色
+
+bool same_grid(const RenderGrid& a, const RenderGrid& b)
+{
+    return a.first == b.first && a.rows == b.rows && a.cols == b.cols && a.spacing == b.spacing && a.type == b.type && a.closed == b.closed;
+}
+
+struct ClipVertex {
+    Vector3f camera;
+    Rgb color;
+};
+
+Rgb lerp(Rgb a, Rgb b, float t)
+{
+    auto mix = [t](uint8_t x, uint8_t y) { return static_cast<uint8_t>(x + (y - x) * t); };
+    return { mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b) };
+}
+}
+
+bool SurfaceMesh::set_grids(std::span<const RenderGrid> grids, size_t particle_count)
+{
+    if (grids.empty())
+        return false;
+    for (const auto& grid : grids) {
+        if (grid.rows < 2 || grid.cols < 2 || grid.first + static_cast<size_t>(grid.rows) * grid.cols > particle_count)
+            return false;
+    }
+    if (cached_particles == particle_count && cached_grids.size() == grids.size()
+        && std::equal(grids.begin(), grids.end(), cached_grids.begin(), same_grid))
+        return true;
+
+    cached_grids.assign(grids.begin(), grids.end());
+    cached_particles = particle_count;
+    triangles.clear();
+    rest_edge.clear();
+    for (const auto& grid : grids) {
+        auto rest = [&](int local) { return grid_rest_position(grid.type, local / grid.cols, local % grid.cols, grid.spacing); };
+        for (int local : grid_triangles(grid.type, grid.rows, grid.cols))
+            triangles.push_back(static_cast<uint32_t>(grid.first + local));
+        for (size_t t = rest_edge.size(); t < triangles.size() / 3; ++t) {
+            Vector3f a = rest(static_cast<int>(triangles[3 * t] - grid.first));
+            Vector3f b = rest(static_cast<int>(triangles[3 * t + 1] - grid.first));
+            Vector3f c = rest(static_cast<int>(triangles[3 * t + 2] - grid.first));
+            rest_edge.push_back(std::max({ (b - a).length(), (c - b).length(), (a - c).length() }));
+        }
+        if (grid.closed) {
+            // 圆筒接缝：每行最后一列与第一列之间补一排三角形
+            for (int r = 0; r < grid.rows - 1; ++r) {
+                uint32_t i = static_cast<uint32_t>(grid.first + static_cast<size_t>(r) * grid.cols + grid.cols - 1);
+                uint32_t right = static_cast<uint32_t>(grid.first + static_cast<size_t>(r) * grid.cols);
+                triangles.insert(triangles.end(), { i, right, right + grid.cols, i, right + grid.cols, i + grid.cols });
+                rest_edge.insert(rest_edge.end(), 2, grid.spacing * std::sqrt(2.0f));
+            }
+        }
+    }
+
+    // 顶点 -> 相邻三角形（CSR）
+    adjacency_offsets.assign(particle_count + 1, 0);
+    for (uint32_t p : triangles)
+        ++adjacency_offsets[p + 1];
+    for (size_t i = 0; i < particle_count; ++i)
+        adjacency_offsets[i + 1] += adjacency_offsets[i];
+    adjacency.resize(triangles.size());
+    std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t k = 0; k < triangles.size(); ++k)
+        adjacency[fill[triangles[k]]++] = static_cast<uint32_t>(k / 3);
+    return true;
+}
+
+void SurfaceMesh::build(std::span<const Vector3f> positions, const ViewFrustum& frustum, std::vector<ScreenVertex>& out)
+{
+    const size_t n = positions.size();
+    const size_t tri_count = triangle_count();
+    camera_positions.resize(n);
+    outcodes.resize(n);
+    face_normals.resize(tri_count);
+    vertex_colors.resize(n);
+
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        camera_positions[i] = frustum.to_camera(positions[i]);
+        outcodes[i] = frustum.outcode(camera_positions[i]);
+    });
+
+    // 面法线（叉积长度即面积的两倍，求和时自然按面积加权）；撕开的三角形不参与着色也不画
+    parallel_compact(tri_count, MIN_CHUNK, 1, visible, [&](size_t t, SortItem* item) -> size_t {
+        const uint32_t a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+        const Vector3f ab = positions[b] - positions[a], ac = positions[c] - positions[a], bc = positions[c] - positions[b];
+        const float limit = RENDER_BREAK_STRETCH * rest_edge[t];
+        if (ab.length() > limit || ac.length() > limit || bc.length() > limit) {
+            face_normals[t] = Vector3f();
+            return 0;
+        }
+        face_normals[t] = ab.cross(ac);
+        if (outcodes[a] & outcodes[b] & outcodes[c])
+            return 0;
+        float depth = std::max((camera_positions[a].z + camera_positions[b].z + camera_positions[c].z) * (1.0f / 3.0f), 0.0f);
+        *item = { ~std::bit_cast<uint32_t>(depth), static_cast<uint32_t>(t) }; // 非负浮点数的位模式与大小同序
+        return 1;
+    });
+
+    // 顶点法线与光照：光从观察者左上方照来，双面着色
+    const Vector3f light = (frustum.forward * -1.0f + frustum.up * 0.6f - frustum.right * 0.3f).normalized();
+    parallel_for(n, MIN_CHUNK, [&](size_t i) {
+        Vector3f normal;
+        for (uint32_t k = adjacency_offsets[i]; k < adjacency_offsets[i + 1]; ++k)
+            normal += face_normals[adjacency[k]];
+        normal = normal.normalized();
+        if (normal.dot(frustum.eye - positions[i]) < 0)
+            normal = normal * -1.0f;
+        float shade = SURFACE_AMBIENT + (1.0f - SURFACE_AMBIENT) * std::max(normal.dot(light), 0.0f);
+        vertex_colors[i] = { static_cast<uint8_t>(SURFACE_BASE_COLOR.r * shade), static_cast<uint8_t>(SURFACE_BASE_COLOR.g * shade),
+            static_cast<uint8_t>(SURFACE_BASE_COLOR.b * shade) };
+    });
+
+    sort_back_to_front();
+
+    // 穿过近平面的三角形在相机空间裁剪成至多四边形，拆成两个三角形
+    parallel_compact(visible.size(), MIN_CHUNK, 6, out, [&](size_t k, ScreenVertex* dst) -> size_t {
+        const uint32_t t = visible[k].triangle;
+        const uint32_t ids[3] = { triangles[3 * t], triangles[3 * t + 1], triangles[3 * t + 2] };
+        if (!((outcodes[ids[0]] | outcodes[ids[1]] | outcodes[ids[2]]) & ViewFrustum::Near)) {
+            for (int j = 0; j < 3; ++j)
+                dst[j] = { frustum.to_screen(camera_positions[ids[j]]), vertex_colors[ids[j]] };
+            return 3;
+        }
+        std::array<ClipVertex, 4> poly;
+        size_t count = 0;
+        for (int j = 0; j < 3; ++j) {
+            const ClipVertex a { camera_positions[ids[j]], vertex_colors[ids[j]] };
+            const ClipVertex b { camera_positions[ids[(j + 1) % 3]], vertex_colors[ids[(j + 1) % 3]] };
+            const bool a_in = a.camera.z > CAMERA_NEAR, b_in = b.camera.z > CAMERA_NEAR;
+            if (a_in)
+                poly[count++] = a;
+            if (a_in != b_in) {
+                float s = (CAMERA_NEAR - a.camera.z) / (b.camera.z - a.camera.z);
+                Vector3f hit = a.camera + (b.camera - a.camera) * s;
+                hit.z = CAMERA_NEAR;
+                poly[count++] = { hit, lerp(a.color, b.color, s) };
+            }
+        }
+        size_t written = 0;
+        for (size_t j = 1; j + 1 < count; ++j) {
+            dst[written++] = { frustum.to_screen(poly[0].camera), poly[0].color };
+            dst[written++] = { frustum.to_screen(poly[j].camera), poly[j].color };
+            dst[written++] = { frustum.to_screen(poly[j + 1].camera), poly[j + 1].color };
+        }
+        return written;
+    });
+}
+
+// 按深度键做 4 趟 8 位基数排序，稳定且与线程调度无关
+void SurfaceMesh::sort_back_to_front()
+{
+    sort_buffer.resize(visible.size());
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::array<size_t, 257> offsets {};
+        for (const auto& item : visible)
+            ++offsets[((item.key >> shift) & 0xFF) + 1];
+        for (size_t d = 0; d < 256; ++d)
+            offsets[d + 1] += offsets[d];
+        for (const auto& item : visible)
+            sort_buffer[offsets[(item.key >> shift) & 0xFF]++] = item;
+        visible.swap(sort_buffer);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "frustum.h"
+#include "render_snapshot.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 着色三角网格：三角形和顶点邻接表由网格拓扑生成一次；每帧并行计算面积加权的顶点法线，
+// 按视锥裁剪、按深度从远到近排序（画家算法），生成一批带光照的三角形顶点。
+// 每帧用到的数组都在成员里复用，稳定后不再分配内存。不依赖 SFML，窗口和离屏渲染共用
+class SurfaceMesh {
+public:
+    // 网格列表变化时重建拓扑。没有可用的规则网格（例如导入的网格）时返回 false
+    bool set_grids(std::span<const RenderGrid> grids, size_t particle_count);
+    size_t triangle_count() const { return triangles.size() / 3; }
+
+    // 生成本帧要画的三角形顶点，out 中每 3 个顶点一个三角形
+    void build(std::span<const Vector3f> positions, const ViewFrustum& frustum, std::vector<ScreenVertex>& out);
+
+private:
+    struct SortItem {
+        uint32_t key; // 深度键，升序即从远到近
+        uint32_t triangle;
+    };
+
+    std::vector<RenderGrid> cached_grids;
+    size_t cached_particles = 0;
+    std::vector<uint32_t> triangles; // 每 3 个粒子下标一个三角形
+    std::vector<float> rest_edge; // 每个三角形最长的静止边长
+    std::vector<uint32_t> adjacency_offsets; // 粒子 i 的相邻三角形为 adjacency[offsets[i], offsets[i + 1])
+    std::vector<uint32_t> adjacency;
+
+    std::vector<Vector3f> camera_positions;
+    std::vector<uint8_t> outcodes;
+    std::vector<Vector3f> face_normals; // 未归一化，长度为三角形面积的两倍
+    std::vector<Rgb> vertex_colors;
+    std::vector<SortItem> visible, sort_buffer;
+
+    void sort_back_to_front();
+};
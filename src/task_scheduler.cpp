@@ -0,0 +1,333 @@
+#include "task_scheduler.h"
+#include <cstdlib>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+const size_t SCRATCH_MIN_BLOCK = 64 * 1024;
+const size_t NO_QUEUE = static_cast<size_t>(-1);
+
+// 当前线程所属的队列下标，非工作线程为 NO_QUEUE
+thread_local size_t this_queue = NO_QUEUE;
+
+struct BatchContext {
+    const std::function<void(size_t)>* fn;
+    std::atomic<size_t> remaining;
+};
+
+struct GraphContext {
+    TaskScheduler* scheduler;
+    TaskGraph* graph;
+    std::unique_ptr<std::atomic<int>[]> dependencies;
+    std::atomic<size_t> remaining;
+};
+
+}
+
+void* ScratchArena::allocate_bytes(size_t bytes, size_t align)
+{
+    while (current < blocks.size()) {
+        Block& b = blocks[current];
+        size_t offset = (b.used + align - 1) / align * align;
+        if (offset + bytes <= b.size) {
+            b.used = offset + bytes;
+            return b.data.get() + offset;
+        }
+        if (current + 1 == blocks.size())
+            break;
+        blocks[++current].used = 0;
+    }
+    size_t size = std::max(bytes + align, blocks.empty() ? SCRATCH_MIN_BLOCK : blocks.back().size * 2);
+    blocks.push_back({ std::make_unique<std::byte[]>(size), size, 0 });
+    current = blocks.size() - 1;
+    return allocate_bytes(bytes, align);
+}
+
+void ScratchArena::release(Mark m)
+{
+    if (blocks.empty())
+        return;
+    for (size_t b = m.block + 1; b < blocks.size(); ++b)
+        blocks[b].used = 0;
+    current = m.block;
+    blocks[current].used = m.used;
+}
+
+TaskGraph::Node TaskGraph::add(std::function<void()> fn, std::span<const Node> after)
+{
+    Node node = nodes.size();
+    nodes.push_back({ std::move(fn), {}, static_cast<int>(after.size()) });
+    for (Node pred : after)
+        nodes[pred].successors.push_back(node);
+    return node;
+}
+
+TaskGroup::Slot& TaskGroup::acquire(std::function<void()> fn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot* slot = free_slots;
+    if (slot)
+        free_slots = slot->next_free;
+    else
+        slot = &slots.emplace_back();
+    slot->fn = std::move(fn);
+    slot->group = this;
+    return *slot;
+}
+
+void TaskGroup::release(Slot& slot)
+{
+    slot.fn = nullptr; // 立即释放捕获的资源（例如存档的副本）
+    std::lock_guard<std::mutex> lock(mutex);
+    slot.next_free = free_slots;
+    free_slots = &slot;
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler()
+{
+    const char* workers = std::getenv("CLOTH_WORKERS");
+    const char* pin = std::getenv("CLOTH_PIN_CORES");
+    start(workers ? static_cast<size_t>(std::max(0, std::atoi(workers))) : 0, pin && std::atoi(pin) != 0);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+void TaskScheduler::configure(size_t workers, bool pin_cores)
+{
+    stop();
+    start(workers, pin_cores);
+}
+
+void TaskScheduler::start(size_t workers, bool pin_cores)
+{
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (workers == 0)
+        workers = cores - 1;
+    queues.clear();
+    for (size_t i = 0; i <= workers; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    threads.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this, i] { worker_loop(i); });
+#if defined(__linux__)
+        if (pin_cores) {
+            // 核 0 留给主线程
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET((i + 1) % cores, &set);
+            pthread_setaffinity_np(threads.back().native_handle(), sizeof(set), &set);
+        }
+#else
+        (void)pin_cores;
+#endif
+    }
+}
+
+void TaskScheduler::stop()
+{
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads)
+        t.join();
+    threads.clear();
+    stopping = false;
+}
+
+void TaskScheduler::worker_loop(size_t index)
+{
+    this_queue = index;
+    for (;;) {
+        Task task;
+        if (try_take(index, true, task)) {
+            task.run(task.context, task.index);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        if (stopping && pending.load() == 0)
+            return;
+        wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+    }
+}
+
+void TaskScheduler::notify()
+{
+    // 持锁一次，保证刚检查完 pending 还没睡下的线程也能收到通知
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_one();
+}
+
+void TaskScheduler::push(const Task& task)
+{
+    Queue& q = *queues[this_queue < threads.size() ? this_queue : threads.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(task);
+    }
+    pending.fetch_add(1);
+    notify();
+}
+
+bool TaskScheduler::try_take(size_t home, bool worker, Task& task)
+{
+    const size_t count = queues.size();
+    if (home < count) {
+        Queue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    for (size_t k = 1; k <= count; ++k) {
+        Queue& victim = *queues[(home + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    if (worker) {
+        std::lock_guard<std::mutex> lock(background.mutex);
+        if (!background.tasks.empty()) {
+            task = background.tasks.front();
+            background.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::help_until(const std::atomic<size_t>& remaining)
+{
+    const size_t home = this_queue < threads.size() ? this_queue : threads.size();
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Task task;
+        if (try_take(home, false, task))
+            task.run(task.context, task.index);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void TaskScheduler::run_batch(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+    BatchContext batch { &fn, count - 1 };
+    auto run = [](void* context, size_t index) {
+        auto* b = static_cast<BatchContext*>(context);
+        (*b->fn)(index);
+        b->remaining.fetch_sub(1, std::memory_order_release);
+    };
+    for (size_t i = count - 1; i >= 1; --i)
+        push({ run, &batch, i });
+    fn(0);
+    help_until(batch.remaining);
+}
+
+void TaskScheduler::run_graph_node(void* context, size_t index)
+{
+    auto* g = static_cast<GraphContext*>(context);
+    const auto& node = g->graph->nodes[index];
+    node.fn();
+    for (TaskGraph::Node next : node.successors) {
+        if (g->dependencies[next].fetch_sub(1) == 1)
+            g->scheduler->push({ run_graph_node, context, next });
+    }
+    g->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskScheduler::run(TaskGraph& graph)
+{
+    const size_t count = graph.nodes.size();
+    if (count == 0)
+        return;
+    GraphContext ctx { this, &graph, std::make_unique<std::atomic<int>[]>(count), count };
+    for (size_t i = 0; i < count; ++i)
+        ctx.dependencies[i].store(graph.nodes[i].dependencies);
+    for (size_t i = 0; i < count; ++i) {
+        if (graph.nodes[i].dependencies == 0)
+            push({ run_graph_node, &ctx, i });
+    }
+    help_until(ctx.remaining);
+}
+
+void TaskScheduler::async(std::function<void()> fn)
+{
+    async(detached, std::move(fn));
+}
+
+void TaskScheduler::async(TaskGroup& group, std::function<void()> fn)
+{
+    if (threads.empty()) {
+        fn();
+        return;
+    }
+    group.remaining.fetch_add(1);
+    outstanding.fetch_add(1);
+    TaskGroup::Slot& slot = group.acquire(std::move(fn));
+    auto run = [](void* context, size_t) {
+        auto& s = *static_cast<TaskGroup::Slot*>(context);
+        TaskGroup& g = *s.group;
+        s.fn();
+        // 先归还上下文再减计数：计数归零后等待方可能立即销毁 group
+        g.release(s);
+        g.remaining.fetch_sub(1, std::memory_order_release);
+        TaskScheduler::instance().finish_background();
+    };
+    {
+        std::lock_guard<std::mutex> lock(background.mutex);
+        background.tasks.push_back({ run, &slot, 0 });
+    }
+    pending.fetch_add(1);
+    notify();
+}
+
+void TaskScheduler::wait(TaskGroup& group)
+{
+    help_until(group.remaining);
+}
+
+void TaskScheduler::finish_background()
+{
+    if (outstanding.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    // 持锁一次，保证刚检查完 outstanding 还没睡下的 wait_idle 也能收到通知
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    idle.notify_all();
+}
+
+void TaskScheduler::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    idle.wait(lock, [this] { return outstanding.load(std::memory_order_acquire) == 0; });
+}
+
+ScratchArena& TaskScheduler::scratch()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
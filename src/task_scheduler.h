@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 线程私有的临时内存：按块向后分配，用 ScratchScope 整段归还。
+// 已分配的地址在归还前保持不变，只用于可平凡复制的类型
+class ScratchArena {
+public:
+    struct Mark {
+        size_t block, used;
+    };
+
+    template <typename T>
+    std::span<T> allocate(size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "scratch memory holds trivially copyable types only");
+        T* data = static_cast<T*>(allocate_bytes(count * sizeof(T), alignof(T)));
+        std::fill(data, data + count, T {});
+        return { data, count };
+    }
+
+    Mark mark() const { return { current, blocks.empty() ? 0 : blocks[current].used }; }
+    void release(Mark m);
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0, used = 0;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;
+
+    void* allocate_bytes(size_t bytes, size_t align);
+};
+
+// 作用域内分配的临时内存在析构时归还
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena& arena)
+        : arena(arena)
+        , saved(arena.mark())
+    {
+    }
+    ~ScratchScope() { arena.release(saved); }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark saved;
+};
+
+// 任务图：节点在所有前驱完成后才会被调度，无依赖的节点可以并行
+class TaskGraph {
+public:
+    using Node = size_t;
+
+    // after 中的节点全部完成后才执行 fn
+    Node add(std::function<void()> fn, std::span<const Node> after);
+    Node add(std::function<void()> fn, std::initializer_list<Node> after = {}) { return add(std::move(fn), std::span<const Node>(after.begin(), after.size())); }
+    size_t size() const { return nodes.size(); }
+    void clear() { nodes.clear(); }
+
+private:
+    friend class TaskScheduler;
+    struct NodeData {
+        std::function<void()> fn;
+        std::vector<Node> successors;
+        int dependencies = 0;
+    };
+    std::vector<NodeData> nodes;
+};
+
+// 一组后台任务的完成计数，用于等待 async 提交的任务。
+// 任务的上下文存放在组内，完成后回收给同组的下一个任务，反复提交时不再分配
+class TaskGroup {
+public:
+    bool done() const { return remaining.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskScheduler;
+    struct Slot {
+        std::function<void()> fn;
+        TaskGroup* group;
+        Slot* next_free = nullptr;
+    };
+    std::atomic<size_t> remaining { 0 };
+    std::mutex mutex; // 保护 slots 和 free_slots
+    std::deque<Slot> slots; // 只在队尾追加，地址不变
+    Slot* free_slots = nullptr;
+
+    Slot& acquire(std::function<void()> fn);
+    void release(Slot& slot);
+};
+
+// 全进程共用的工作窃取调度器。每个工作线程有自己的任务队列，
+// 自己从队尾取（后进先出，缓存友好），空闲时从别的队列队首窃取；
+// 等待任务完成的线程（包括主线程）也会参与执行，因此任务中可以再嵌套并行。
+// 线程数和绑核可由环境变量 CLOTH_WORKERS、CLOTH_PIN_CORES=1 设置，或在启动时调用 configure
+class TaskScheduler {
+public:
+    static TaskScheduler& instance();
+    ~TaskScheduler();
+
+    // 重建工作线程：workers 为 0 时使用核数 - 1；pin_cores 为真时工作线程 i 绑定到第 i + 1 个核。
+    // 会先等待已提交的任务结束
+    void configure(size_t workers, bool pin_cores);
+    size_t worker_count() const { return threads.size(); }
+
+    // 执行 fn(0) ... fn(count - 1)，全部完成后返回
+    void run_batch(size_t count, const std::function<void(size_t)>& fn);
+    // 执行任务图中的所有节点，全部完成后返回
+    void run(TaskGraph& graph);
+    // 提交独立的后台任务（存盘、写录制文件等），不等待完成；没有工作线程时就地执行
+    void async(std::function<void()> fn);
+    // 同上，并计入 group，可用 wait(group) 等待完成
+    void async(TaskGroup& group, std::function<void()> fn);
+    // 等待 group 中的任务结束，期间帮忙执行普通任务
+    void wait(TaskGroup& group);
+    // 等待所有已提交的任务结束
+    void wait_idle();
+
+    // 当前线程的临时内存
+    static ScratchArena& scratch();
+
+private:
+    // 队列中的任务：run(context, index)，不做内存分配
+    struct Task {
+        void (*run)(void* context, size_t index);
+        void* context;
+        size_t index;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // 每个工作线程一个队列，最后一个接收非工作线程提交的任务
+    std::vector<std::unique_ptr<Queue>> queues;
+    // 后台任务单独排队，只由工作线程执行，等待并行结果的线程不会被它们拖住
+    Queue background;
+    TaskGroup detached; // 不需要等待的后台任务
+    std::vector<std::thread> threads;
+    std::atomic<size_t> pending { 0 }; // 已入队未取出的任务数
+    std::atomic<size_t> outstanding { 0 }; // 已提交未完成的后台任务数
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::condition_variable idle; // outstanding 归零时通知 wait_idle
+    bool stopping = false;
+
+    TaskScheduler();
+    void start(size_t workers, bool pin_cores);
+    void stop();
+    void worker_loop(size_t index);
+    void push(const Task& task);
+    void notify();
+    // 一个后台任务执行完毕：outstanding 减一，归零时唤醒 wait_idle
+    void finish_background();
+    // 取一个任务：先取自己队列的队尾，再从其他队列队首窃取；worker 为真时最后才取后台任务
+    bool try_take(size_t home, bool worker, Task& task);
+    // 一边执行队列中的任务一边等待 remaining 归零
+    void help_until(const std::atomic<size_t>& remaining);
+    // 执行任务图的一个节点，并把依赖已满足的后继节点入队
+    static void run_graph_node(void* context, size_t index);
+};
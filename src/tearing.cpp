@@ -0,0 +1,219 @@
+#include "tearing.h"
+#include "parallel.h"
+#include "particle_rebind.h"
+#include <algorithm>
+
+namespace {
+const size_t MIN_CHUNK = 4096;
+
+uint32_t other_end(const Constraint& c, const Particle* p, const Particle* base)
+{
+    return static_cast<uint32_t>((c.p1 == p ? c.p2 : c.p1) - base);
+}
+
+Particle*& end_at(Constraint& c, const Particle* p)
+{
+    return c.p1 == p ? c.p1 : c.p2;
+}
+
+Particle*& end_at(DihedralConstraint& d, const Particle* p)
+{
+    return d.p1 == p ? d.p1 : d.p2 == p ? d.p2 : d.p3 == p ? d.p3 : d.p4;
+}
+}
+
+void Tearing::collect(std::span<const Constraint> constraints, std::span<const float> strain, float threshold)
+{
+    if (strain.size() != constraints.size()) {
+        candidates.clear();
+        return;
+    }
+    parallel_compact(constraints.size(), MIN_CHUNK, 1, candidates, [&](size_t i, uint32_t* out) -> size_t {
+        const Constraint& c = constraints[i];
+        if (!c.active || strain[i] <= threshold)
+            return 0;
+        const Vector3f d = c.p2->position - c.p1->position;
+        if (d.dot(d) <= c.initial_length * c.initial_length)
+            return 0;
+        *out = static_cast<uint32_t>(i);
+        return 1;
+    });
+}
+
+void Tearing::build_links(std::span<const Particle> particles, std::span<const Constraint> constraints,
+    std::span<const DihedralConstraint> dihedrals)
+{
+    const Particle* base = particles.data();
+    constraint_links.assign(particles.size(), {});
+    dihedral_links.assign(particles.size(), {});
+    for (size_t i = 0; i < constraints.size(); ++i) {
+        constraint_links[constraints[i].p1 - base].push_back(static_cast<uint32_t>(i));
+        constraint_links[constraints[i].p2 - base].push_back(static_cast<uint32_t>(i));
+    }
+    for (size_t i = 0; i < dihedrals.size(); ++i) {
+        for (const Particle* p : { dihedrals[i].p1, dihedrals[i].p2, dihedrals[i].p3, dihedrals[i].p4 })
+            dihedral_links[p - base].push_back(static_cast<uint32_t>(i));
+    }
+    links_valid = true;
+    linked_constraints = constraints.data();
+    linked_constraint_count = constraints.size();
+    linked_dihedral_count = dihedrals.size();
+    linked_particle_count = particles.size();
+}
+
+TearResult Tearing::apply(std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+    std::vector<DihedralConstraint>& dihedrals)
+{
+    TearResult result;
+    if (candidates.empty())
+        return result;
+    if (!links_valid || linked_constraints != constraints.data() || linked_constraint_count != constraints.size()
+        || linked_dihedral_count != dihedrals.size() || linked_particle_count != particles.size())
+        build_links(particles, constraints, dihedrals);
+
+    // 先全部断开，再逐个检查两端的粒子，分裂结果与候选的先后无关
+    const Particle* base = particles.data();
+    std::vector<uint32_t> touched;
+    touched.reserve(candidates.size() * 2);
+    for (uint32_t k : candidates) {
+        Constraint& c = constraints[k];
+        if (!c.active)
+            continue;
+        c.deactivate();
+        ++result.broken;
+        const uint32_t a = static_cast<uint32_t>(c.p1 - base), b = static_cast<uint32_t>(c.p2 - base);
+        // 两端都在的二面角约束跨过了断口，一并失效
+        for (uint32_t d : dihedral_links[a]) {
+            if (dihedrals[d].uses(c.p2))
+                dihedrals[d].deactivate();
+        }
+        touched.push_back(a);
+        touched.push_back(b);
+    }
+    candidates.clear();
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    // 一个粒子至多分成它仍连着的约束数那么多份；先留足容量，分裂时追加粒子不再搬家
+    size_t bound = 0;
+    for (uint32_t i : touched) {
+        for (uint32_t k : constraint_links[i])
+            bound += constraints[k].active ? 1 : 0;
+    }
+    if (particles.size() + bound > particles.capacity()) {
+        // 扩容会释放旧数组，旧地址先记成整数
+        const auto old_base = reinterpret_cast<std::uintptr_t>(particles.data());
+        const size_t count = particles.size();
+        particles.reserve(std::max(count + bound, particles.capacity() * 3 / 2));
+        rebind_particles(constraints, old_base, count, particles.data());
+        rebind_particles(dihedrals, old_base, count, particles.data());
+        result.particles_moved = reinterpret_cast<std::uintptr_t>(particles.data()) != old_base;
+    }
+    for (uint32_t i : touched)
+        result.split += split_particle(i, particles, constraints, dihedrals);
+    linked_particle_count = particles.size();
+    return result;
+}
+
+// 以粒子 index 的邻居（经有效约束相连的粒子）为点、邻居之间的有效约束为边求连通分量；
+// 多于一片时约束最多的一片留在原粒子上，其余每片复制出一个新粒子并把相关约束改连过去
+size_t Tearing::split_particle(uint32_t index, std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+    std::vector<DihedralConstraint>& dihedrals)
+{
+    const Particle* base = particles.data();
+    const Particle* self = base + index;
+    std::vector<uint32_t> neighbors;
+    std::vector<std::pair<uint32_t, uint32_t>> edges; // (约束下标, 邻居序号)
+    auto slot_of = [&](uint32_t p) -> int {
+        auto it = std::find(neighbors.begin(), neighbors.end(), p);
+        return it == neighbors.end() ? -1 : static_cast<int>(it - neighbors.begin());
+    };
+    for (uint32_t k : constraint_links[index]) {
+        if (!constraints[k].active)
+            continue;
+        const uint32_t other = other_end(constraints[k], self, base);
+        int slot = slot_of(other);
+        if (slot < 0) {
+            slot = static_cast<int>(neighbors.size());
+            neighbors.push_back(other);
+        }
+        edges.push_back({ k, static_cast<uint32_t>(slot) });
+    }
+    if (neighbors.size() < 2)
+        return 0;
+
+    // 并查集
+    std::vector<uint32_t> parent(neighbors.size());
+    for (uint32_t s = 0; s < parent.size(); ++s)
+        parent[s] = s;
+    auto find = [&](uint32_t s) {
+        while (parent[s] != s)
+            s = parent[s] = parent[parent[s]];
+        return s;
+    };
+    for (uint32_t s = 0; s < neighbors.size(); ++s) {
+        for (uint32_t k : constraint_links[neighbors[s]]) {
+            if (!constraints[k].active)
+                continue;
+            const uint32_t w = other_end(constraints[k], base + neighbors[s], base);
+            int t = w == index ? -1 : slot_of(w);
+            if (t >= 0)
+                parent[find(s)] = find(static_cast<uint32_t>(t));
+        }
+    }
+    std::vector<int> component(neighbors.size(), -1);
+    std::vector<size_t> weight;
+    for (uint32_t s = 0; s < neighbors.size(); ++s) {
+        const uint32_t root = find(s);
+        if (component[root] < 0) {
+            component[root] = static_cast<int>(weight.size());
+            weight.push_back(0);
+        }
+        component[s] = component[root];
+    }
+    if (weight.size() < 2)
+        return 0;
+    for (const auto& [k, s] : edges)
+        ++weight[component[s]];
+    const int keep = static_cast<int>(std::max_element(weight.begin(), weight.end()) - weight.begin());
+
+    // 其余各片的新粒子（容量已由 apply 预留，追加不会搬家）
+    std::vector<uint32_t> target(weight.size(), index);
+    for (size_t c = 0; c < weight.size(); ++c) {
+        if (static_cast<int>(c) == keep)
+            continue;
+        target[c] = static_cast<uint32_t>(particles.size());
+        particles.push_back(particles[index]);
+        constraint_links.emplace_back();
+        dihedral_links.emplace_back();
+    }
+    Particle* const origin = particles.data() + index;
+    for (const auto& [k, s] : edges) {
+        const uint32_t to = target[component[s]];
+        if (to == index)
+            continue;
+        end_at(constraints[k], origin) = particles.data() + to;
+        constraint_links[to].push_back(k);
+    }
+    std::erase_if(constraint_links[index], [&](uint32_t k) { return constraints[k].p1 != origin && constraints[k].p2 != origin; });
+
+    // 二面角约束跟随它的其余顶点所在的那一片
+    for (uint32_t d : dihedral_links[index]) {
+        DihedralConstraint& dc = dihedrals[d];
+        if (!dc.active)
+            continue;
+        for (const Particle* p : { dc.p1, dc.p2, dc.p3, dc.p4 }) {
+            const int slot = p == origin ? -1 : slot_of(static_cast<uint32_t>(p - base));
+            if (slot < 0)
+                continue;
+            const uint32_t to = target[component[slot]];
+            if (to != index) {
+                end_at(dc, origin) = particles.data() + to;
+                dihedral_links[to].push_back(d);
+            }
+            break;
+        }
+    }
+    std::erase_if(dihedral_links[index], [&](uint32_t d) { return !dihedrals[d].uses(origin); });
+    return weight.size() - 1;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "constraint.h"
+#include "dihedral_constraint.h"
+#include "particle.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 一次批量撕裂的结果
+struct TearResult {
+    size_t broken = 0; // 断开的约束数
+    size_t split = 0; // 新分裂出的粒子数
+    bool particles_moved = false; // 粒子数组扩容搬家，外部保存的粒子指针需要更新
+};
+
+// 按应变阈值自动撕裂。
+// 求解后用求解器写出的应变并行收集候选约束（collect），在步边界一次性断开（apply）：
+// 断口穿过某个粒子、使它周围的布面分成互不相连的几片时，把它分裂成每片一个粒子。
+// 粒子 -> 约束的邻接表只在首次使用或外部改动拓扑后整体建立，撕裂时增量更新
+class Tearing {
+public:
+    // 找出应变超过 threshold 且处于拉伸状态的有效约束（折叠时的压缩不算）
+    void collect(std::span<const Constraint> constraints, std::span<const float> strain, float threshold);
+    bool has_candidates() const { return !candidates.empty(); }
+
+    // 断开候选约束并分裂粒子；新粒子追加在数组末尾
+    TearResult apply(std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+        std::vector<DihedralConstraint>& dihedrals);
+
+    // 重置、加载、手动撕裂等改动了粒子或约束数组之后调用
+    void invalidate()
+    {
+        candidates.clear();
+        links_valid = false;
+    }
+
+private:
+    std::vector<uint32_t> candidates; // 约束下标，升序
+    std::vector<std::vector<uint32_t>> constraint_links; // 粒子 -> 约束下标（含已断开的）
+    std::vector<std::vector<uint32_t>> dihedral_links; // 粒子 -> 二面角约束下标
+    bool links_valid = false;
+    const Constraint* linked_constraints = nullptr;
+    size_t linked_constraint_count = 0, linked_dihedral_count = 0, linked_particle_count = 0;
+
+    void build_links(std::span<const Particle> particles, std::span<const Constraint> constraints,
+        std::span<const DihedralConstraint> dihedrals);
+    size_t split_particle(uint32_t index, std::vector<Particle>& particles, std::vector<Constraint>& constraints,
+        std::vector<DihedralConstraint>& dihedrals);
+};
@@ -0,0 +1,80 @@
+#include "tether.h"
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+void TetherSet::rebuild(std::span<const Particle> particles, std::span<const Constraint> constraints)
+{
+    tethers.clear();
+    const int n = static_cast<int>(particles.size());
+    if (n == 0)
+        return;
+
+    // 邻接表（CSR）
+    const Particle* base = particles.data();
+    std::vector<int> offsets(n + 1, 0);
+    for (const auto& c : constraints) {
+        if (!c.active)
+            continue;
+        offsets[c.p1 - base + 1]++;
+        offsets[c.p2 - base + 1]++;
+    }
+    for (int i = 0; i < n; ++i)
+        offsets[i + 1] += offsets[i];
+    std::vector<std::pair<int, float>> edges(offsets[n]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& c : constraints) {
+        if (!c.active)
+            continue;
+        int a = static_cast<int>(c.p1 - base);
+        int b = static_cast<int>(c.p2 - base);
+        edges[fill[a]++] = { b, c.initial_length };
+        edges[fill[b]++] = { a, c.initial_length };
+    }
+
+    // 多源 Dijkstra
+    std::vector<float> dist(n, std::numeric_limits<float>::infinity());
+    std::vector<int> anchor(n, -1);
+    using Item = std::pair<float, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (int i = 0; i < n; ++i) {
+        if (particles[i].is_pinned) {
+            dist[i] = 0.0f;
+            anchor[i] = i;
+            queue.push({ 0.0f, i });
+        }
+    }
+    while (!queue.empty()) {
+        auto [d, u] = queue.top();
+        queue.pop();
+        if (d > dist[u])
+            continue;
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            auto [v, len] = edges[e];
+            float nd = d + len;
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                anchor[v] = anchor[u];
+                queue.push({ nd, v });
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (!particles[i].is_pinned && anchor[i] >= 0)
+            tethers.push_back({ i, anchor[i], dist[i] });
+    }
+}
+
+void TetherSet::apply(std::span<Particle> particles) const
+{
+    for (const auto& t : tethers) {
+        Particle& p = particles[t.particle];
+        const Vector3f& a = particles[t.anchor].position;
+        Vector3f delta = p.position - a;
+        float len = delta.length();
+        if (len > t.max_length)
+            p.position = a + delta * (t.max_length / len);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "constraint.h"
+#include "particle.h"
+#include <span>
+#include <vector>
+
+// 长程附着约束：粒子与其测地距离最近的固定粒子之间的单边距离上限
+struct Tether {
+    int particle;
+    int anchor;
+    float max_length; // 沿约束网络的静止测地距离
+};
+
+class TetherSet {
+public:
+    // 以所有固定粒子为源做 Dijkstra，为每个可达的自由粒子生成一条系绳
+    void rebuild(std::span<const Particle> particles, std::span<const Constraint> constraints);
+
+    // 超出长度上限时把粒子拉回；各系绳只写自己的粒子，可并行执行
+    void apply(std::span<Particle> particles) const;
+
+    void clear() { tethers.clear(); }
+    size_t size() const { return tethers.size(); }
+
+private:
+    std::vector<Tether> tethers;
+};